@@ -0,0 +1,28 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+/**
+ * Default depth to which the benchmark positions are searched.
+ */
+#define BENCH_DEPTH 6
+
+/**
+ * Run the speed benchmark: search every benchmark position to the given depth
+ * with a single thread, each from an empty hash table, and report the nodes
+ * and time of each search and the total time, nodes and nodes per second.
+ * The total number of nodes depends only on the search, so it doubles as a
+ * signature detecting changes of its behavior.
+ * Every line of the report starts with `prefix` (the comment symbol when it
+ * is sent to xboard, so that it is not taken for commands).
+ */
+void bench_run(int depth, const char *prefix);
+
+/**
+ * Run the parallel search benchmark: search every benchmark position
+ * to the given depth with 1, 2, 4, 8 and 16 threads and report for each
+ * thread count the time, the number of nodes, the speedup and the
+ * search overhead (extra nodes) relative to the single-threaded search.
+ */
+void bench_smp(int depth);
+
+#endif // BENCH_H
@@ -86,6 +86,85 @@ static inline enum square bb_scan_msb(bb_t bb) {
     return 8*sizeof(bb_t)-1-__builtin_clzll(bb);
 }
 
+/**
+ * Shift a bitboard one square towards the given side of the board
+ * (squares shifted off the board are dropped).
+ */
+static inline bb_t bb_shift_north(bb_t bb) {
+    return bb << 8;
+}
+
+static inline bb_t bb_shift_south(bb_t bb) {
+    return bb >> 8;
+}
+
+static inline bb_t bb_shift_east(bb_t bb) {
+    return (bb << 1) & ~(bb_t)0x0101010101010101; // not onto file A
+}
+
+static inline bb_t bb_shift_west(bb_t bb) {
+    return (bb >> 1) & ~(bb_t)0x8080808080808080; // not onto file H
+}
+
+/**
+ * Shift a bitboard one square forward from the point of view of the given color.
+ */
+static inline bb_t bb_shift_forward(enum color c, bb_t bb) {
+    return c == WHITE ? bb_shift_north(bb) : bb_shift_south(bb);
+}
+
+/**
+ * Fill a bitboard with the squares north (or south) of its set squares,
+ * the set squares included (Kogge-Stone fill).
+ */
+static inline bb_t bb_fill_north(bb_t bb) {
+    bb |= bb << 8;
+    bb |= bb << 16;
+    bb |= bb << 32;
+
+    return bb;
+}
+
+static inline bb_t bb_fill_south(bb_t bb) {
+    bb |= bb >> 8;
+    bb |= bb >> 16;
+    bb |= bb >> 32;
+
+    return bb;
+}
+
+/**
+ * Fill the files of the set squares of a bitboard.
+ */
+static inline bb_t bb_fill_files(bb_t bb) {
+    return bb_fill_north(bb) | bb_fill_south(bb);
+}
+
+/**
+ * Get the squares in front of the set squares of a bitboard
+ * (the set squares excluded) from the point of view of the given color.
+ */
+static inline bb_t bb_span_front(enum color c, bb_t bb) {
+    return c == WHITE ? bb_fill_north(bb_shift_north(bb)) : bb_fill_south(bb_shift_south(bb));
+}
+
+/**
+ * Get the squares behind the set squares of a bitboard
+ * (the set squares excluded) from the point of view of the given color.
+ */
+static inline bb_t bb_span_rear(enum color c, bb_t bb) {
+    return bb_span_front(color_flip(c), bb);
+}
+
+/**
+ * Get the squares attacked by all the pawns of a bitboard at once.
+ */
+static inline bb_t bb_pawn_attacks_set(enum color c, bb_t bb_pawns) {
+    bb_t bb_pushed = bb_shift_forward(c, bb_pawns);
+
+    return bb_shift_east(bb_pushed) | bb_shift_west(bb_pushed);
+}
+
 /**
  * Initialize various useful bitboards.
  */
@@ -2,9 +2,12 @@
 #define BOARD_H
 
 #include "move.h"
+#include "score.h"
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 /**
@@ -142,6 +145,16 @@ static inline enum square rank_file_to_square(enum rank r, enum file f) {
     return RK_CNT*r+f;
 }
 
+/**
+ * Get the distance between two squares in king moves.
+ */
+static inline int square_distance(enum square s1, enum square s2) {
+    int rank_dist = abs((int)square_to_rank(s1) - (int)square_to_rank(s2));
+    int file_dist = abs((int)square_to_file(s1) - (int)square_to_file(s2));
+
+    return rank_dist > file_dist ? rank_dist : file_dist;
+}
+
 /**
  * Convert a string representing a sqaure to square.
  */
@@ -297,6 +310,7 @@ enum castle_right {
 };
 
 #include "bitboard.h"
+#include "zobrist.h"
 
 /**
  * Array index for accessing piece bitboard
@@ -316,9 +330,28 @@ enum bb_pieces_idx {
     BB_PIECES_SZ, // array size
 };
 
+/**
+ * Maximum number of piece changes made by a move
+ * (a capturing promotion removes, moves, removes and adds a piece).
+ */
+#define BOARD_CHANGES_MAX 4
+
+/**
+ * Change of a piece made by a move: the piece is added if `from`
+ * is `SQ_NONE`, removed if `to` is `SQ_NONE` and moved otherwise.
+ */
+struct board_change {
+    int8_t color;
+    int8_t piece;
+    int8_t from;
+    int8_t to;
+};
+
 struct board {
     bb_t bb_pieces[COLOR_CNT][BB_PIECES_SZ]; // array for all bitboards used to store board state
-    int pst_scores[COLOR_CNT];
+    score_t pst_scores[COLOR_CNT]; // sums of the PST values of the pieces (updated incrementally)
+
+    uint8_t piece_cnts[COLOR_CNT][PIECE_CNT]; // number of pieces of each type (updated incrementally)
 
     enum color color; // color that is on move
 
@@ -328,6 +361,36 @@ struct board {
 
     size_t halfmove_clock; // number of plies since last capture or pawn move
     size_t fullmove_number; // number of full moves since game start
+
+    zb_key_t key; // Zobrist key of the game state (updated incrementally)
+    zb_key_t pawn_key; // Zobrist key of the pawns alone (updated incrementally)
+    zb_key_t material_key; // Zobrist key of the piece counts (updated incrementally)
+
+    zb_key_t prev_key; // key before the last move (ZB_KEY_EMPTY if the position was set up)
+    struct board_change changes[BOARD_CHANGES_MAX]; // pieces changed by the last move
+    uint8_t change_cnt;
+};
+
+/**
+ * Number of attack maps (must be a power of 2) cached by each thread.
+ */
+#define BOARD_ATTACKS_CNT 64
+
+/**
+ * Attack maps of a position, computed once and shared by the evaluation,
+ * the move generation and the legality checks. Attacked squares include
+ * the ones occupied by pieces of the same color (defended pieces).
+ */
+struct board_attacks {
+    bb_t by_square[SQ_CNT]; // attacks of the piece on each occupied square
+    bb_t by_piece[COLOR_CNT][PIECE_CNT]; // squares attacked by the pieces of each type
+    bb_t by_color[COLOR_CNT]; // squares attacked by each color
+    bb_t double_attacks[COLOR_CNT]; // squares attacked at least twice by each color
+
+    bb_t checkers; // opponent pieces giving check to the side to move
+    bb_t pinned; // pieces of the side to move pinned to their king
+
+    zb_key_t key; // key of the position (ZB_KEY_EMPTY if not computed)
 };
 
 /**
@@ -340,12 +403,24 @@ void board_reset(struct board *board);
  */
 void board_set_fen(struct board *board, const char *fen);
 
+/**
+ * Recompute the sums of the PST values of the pieces on the board,
+ * e.g. after the evaluation parameters have changed.
+ */
+void board_update_pst(struct board *board);
+
 /**
  * Verify if the provided square is under attack from the
  * perspective of the specified color.
  */
 bool board_square_under_attack(struct board *board, enum color c, enum square s);
 
+/**
+ * Get a bitboard of the pieces of both colors attacking the provided square,
+ * considering the provided occupancy for sliding pieces.
+ */
+bb_t board_get_attackers(struct board *board, enum square s, bb_t bb_occ);
+
 /**
  * Verify if the provided color is currently in check.
  */
@@ -362,10 +437,11 @@ bool board_color_castle_king(struct board *board, enum color c);
 bool board_color_castle_queen(struct board *board, enum color c);
 
 /**
- * Get an attacks bitboard given a piece type, its color and square,
- * taking into consideration the current game table state.
+ * Get the attack maps of the board, computing them only if they are not
+ * among the ones most recently computed by the current thread.
+ * The maps may be overwritten once the thread gets the ones of another board.
  */
-bb_t board_get_attacks(struct board *board, enum color c, enum piece p, enum square s);
+const struct board_attacks * board_get_attack_maps(struct board *board);
 
 /**
  * Execute the provided move on the board for the active color.
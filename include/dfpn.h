@@ -0,0 +1,64 @@
+#ifndef DFPN_H
+#define DFPN_H
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <stddef.h>
+
+/**
+ * Number of buckets (must be a power of 2) and ways per bucket of the
+ * table of proof and disproof numbers (bounds the memory used by the solver).
+ */
+#define DFPN_TABLE_CNT (1 << 19)
+#define DFPN_TABLE_WAYS 2
+
+/**
+ * Default and maximum number of moves of the attacker in a searched mate
+ * (the whole mating line has to fit into a principal variation).
+ */
+#define DFPN_MATE_DEFAULT 8
+#define DFPN_MATE_MAX ((SEARCH_PV_LEN_MAX + 1) / 2)
+
+/**
+ * Free memory occupied by the table of proof and disproof numbers.
+ */
+void dfpn_term(void);
+
+/**
+ * Search a forced mate of the side to move in at most `mate_max` of its moves
+ * with depth-first proof-number search (df-pn), considering only the given
+ * root moves. Unlike alpha-beta, df-pn expands the most proving node of the
+ * tree (the one requiring the least work to prove or disprove the mate) and
+ * needs no evaluation, which makes it prove deep mates far faster.
+ * The search honors the limits of the current search (see `search_stopped`).
+ * Stores into `pv` the mating line (with the longest defense found) and
+ * returns its length, or returns 0 if there is no mate or it was not proven
+ * before the search stopped. Entries of the proof evicted from the table are
+ * solved again while following it, and a line that does not end in mate is
+ * never returned.
+ */
+size_t dfpn_solve(struct board *board, const struct move_list *moves, int mate_max,
+                  struct move pv[SEARCH_PV_LEN_MAX]);
+
+/**
+ * Get the number of nodes visited by the last solve.
+ */
+unsigned long long dfpn_get_nodes(void);
+
+/**
+ * Get the number of moves of the attacker in the mate proven by the last
+ * solve (0 if there is none). It is taken from the proof of the returned line
+ * and of the other defenses along it, so the line may be shorter.
+ */
+int dfpn_get_mate_len(void);
+
+/**
+ * Solve the given position without time limit and print
+ * its mating line or "no mate" (puzzle verification).
+ */
+void dfpn_mate(const char *fen, int mate_max);
+
+#endif // DFPN_H
@@ -0,0 +1,55 @@
+#ifndef ENDGAME_H
+#define ENDGAME_H
+
+#include "board.h"
+
+/**
+ * Score of a won endgame (from the point of view of the winning side) on top
+ * of the progress made towards the mate, above any material balance but below
+ * mate scores.
+ */
+#define EG_KNOWN_WIN 10000
+
+/**
+ * Scale returned by a scale function when it does not apply to the position.
+ */
+#define EG_SCALE_NONE (-1)
+
+/**
+ * Specialized evaluation of an endgame, returning the score from the point
+ * of view of the given stronger side (the one with the material advantage).
+ */
+typedef int eg_eval_fn(struct board *board, enum color strong);
+
+/**
+ * Specialized scale of the endgame score of the given side when it is ahead
+ * (in 64ths, see `enum scale`), or `EG_SCALE_NONE` to keep the scale given
+ * by the piece counts.
+ */
+typedef int eg_scale_fn(struct board *board, enum color strong);
+
+/**
+ * Register the specialized endgames and build the KPK bitbase.
+ * Must be called after the Zobrist keys are initialized.
+ */
+void eg_init(void);
+
+/**
+ * Get the specialized evaluation of the endgame of the given board
+ * (`NULL` if there is none) and its stronger side. Exact material signatures
+ * (e.g. KBNK) are looked up by the material key of the board; a lone king
+ * against mating material is recognized from the piece counts.
+ *
+ * Only depends on the piece counts, so it is meant to be cached along with
+ * the other material terms.
+ */
+eg_eval_fn * eg_get_eval(struct board *board, enum color *strong);
+
+/**
+ * Get the specialized scale function of the endgame of the given board when
+ * the given side is ahead (`NULL` if there is none). Only depends on the piece
+ * counts, like `eg_get_eval`.
+ */
+eg_scale_fn * eg_get_scale(struct board *board, enum color strong);
+
+#endif // ENDGAME_H
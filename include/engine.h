@@ -4,6 +4,7 @@
 #include "board.h"
 #include "move.h"
 #include "movegen.h"
+#include "search.h"
 #include "xboard.h"
 
 #include <stdbool.h>
@@ -17,11 +18,13 @@ struct engine {
     bool force;
     bool computer;
     bool hard;
-    bool post;
+    bool analyze;
 
     int time;
     int time_other;
 
+    struct search_options search_options;
+
     struct board board;
 };
 
@@ -56,4 +59,11 @@ void engine_recv_move(struct move move);
  */
 void engine_send_move(void);
 
+/**
+ * Analyze the current position, sending the thinking output
+ * to xboard without making a move, until input from xboard arrives
+ * (or the search reaches its maximum depth).
+ */
+void engine_analyze(void);
+
 #endif // ENGINGE_H
@@ -2,8 +2,10 @@
 #define EVAL_H
 
 #include "board.h"
+#include "endgame.h"
 #include "movegen.h"
 #include "pst.h"
+#include "score.h"
 #include <stdbool.h>
 #include <assert.h>
 
@@ -36,78 +38,160 @@ extern bb_t pawn_shields[COLOR_CNT][SQ_CNT];
 extern void init_shields();
 
 /**
- *  Values of each piece. Used in score calculation.
+ * Weights of the pieces in the game phase, which goes from PHASE_MAX
+ * with all the pieces on the board down to 0 with only kings and pawns.
  */
-enum piece_value {
-    PAWN_VALUE      = 100,
-    KNIGHT_VALUE    = 350, // 320,
-    BISHOP_VALUE    = 375, // 330,
-    ROOK_VALUE      = 500, // 500,
-    QUEEN_VALUE     = 1000, // 900
+enum phase {
+    KNIGHT_PHASE    = 1,
+    BISHOP_PHASE    = 1,
+    ROOK_PHASE      = 2,
+    QUEEN_PHASE     = 4,
+
+    PHASE_MAX       = 24
 };
 
 /**
- * Values representing bonus score.
+ * Factors (in 64ths) by which the endgame score of the side ahead is scaled
+ * in endgames that are harder to win than the material suggests.
  */
-enum bonus {
-    MOBILITY_BONUS          = 1,
-    KING_PAWN_SHIELD_BONUS  = 7,
-    BISHOP_PAIR_BONUS       = 10,
-    ROOK_OPEN_FILE_BONUS    = 15
+enum scale {
+    SCALE_DRAW      = 0,
+    SCALE_NORMAL    = 64
 };
 
 /**
- * Values representing a penalty to the overall score.
+ * Number of entries (must be a power of 2) of a material hash table.
  */
-enum penalty {
-    ISOLATED_PAWN_PENALTY   = -30,
-    DOUBLED_PAWN_PENALTY    = -25,
-    BACKWARD_PAWN_PENALTY   = -20
+#define MATERIAL_TABLE_CNT (1 << 13)
+
+/**
+ * Entry of a material hash table caching the evaluation terms
+ * that only depend on the piece counts, keyed by the material key of the board.
+ */
+struct material_entry {
+    zb_key_t key;
+
+    score_t score; // material balance and imbalance from the perspective of WHITE
+    int phase; // from PHASE_MAX (opening) down to 0 (pawn endgame)
+
+    int scale[COLOR_CNT]; // scale of the score when the color is ahead
+    eg_scale_fn *scale_fns[COLOR_CNT]; // specialized scale when the color is ahead (NULL if none)
+
+    eg_eval_fn *endgame; // specialized evaluation replacing the whole one (NULL if none)
+    enum color endgame_strong; // stronger side of the specialized evaluation
 };
 
-extern enum piece_value get_piece_value(enum piece piece); // Returns the value of the given piece type.
-extern int evaluate(struct board *board, enum color color); // Returns the score advantage of the given color in centipawns.
+/**
+ * Number of entries (must be a power of 2) of a pawn hash table.
+ */
+#define PAWN_TABLE_CNT (1 << 14)
+
+/**
+ * Entry of a pawn hash table caching the evaluation terms
+ * that only depend on the pawns, keyed by the pawn key of the board.
+ */
+struct pawn_entry {
+    zb_key_t key;
+
+    bb_t backward_stops[COLOR_CNT]; // stop squares of the backward pawns, blocked or not
+
+    score_t score; // isolated and doubled pawn penalties and passed pawn bonuses from the perspective of WHITE
+};
+
+/**
+ * Set the pawn and material hash tables used by the evaluations of the current
+ * thread (`PAWN_TABLE_CNT` and `MATERIAL_TABLE_CNT` entries, zeroed before first
+ * use). Every thread needs its own tables, since entries are not updated
+ * atomically; without them the terms are computed at every evaluation.
+ */
+extern void eval_set_tables(struct pawn_entry *pawn_table, struct material_entry *material_table);
+
+extern int get_piece_value(enum piece piece); // Returns the value of the given piece type (see `struct eval_params`).
+
+/**
+ * Returns the material balance (from the perspective of the moving color)
+ * of the sequence of captures on the destination square of the given move,
+ * assuming both sides always recapture with their least valuable piece.
+ *
+ * Used to tell winning captures from losing ones.
+ */
+extern int static_exchange_evaluation(struct board *board, struct move move);
+/**
+ * Returns the score advantage of the given color in centipawns. All the terms
+ * are summed as packed midgame and endgame values, which are only blended
+ * at the end according to the game phase (tapered evaluation).
+ * Endgames with a specialized evaluation (see `eg_get_eval`) are evaluated
+ * by it; otherwise, when a network is loaded (see `nnue_load`),
+ * it evaluates the board instead.
+ */
+extern int evaluate(struct board *board, enum color color);
+
+/**
+ * Amount (in centipawns) by which the terms that are not kept incrementally
+ * (mobility, king safety, rook files, pawn structure, passed pawns) are
+ * expected to move at most the score computed from material and piece-square
+ * values alone. It is a measured bound, not a guarantee: searching the bench
+ * positions and a set of test positions (77M evaluations) these terms moved
+ * it by at most 362 centipawns (259 without the passed pawns, which are worth
+ * the most in endgames), and by more than 250 in fewer than 1 in 3500
+ * evaluations.
+ */
+#define LAZY_EVAL_MARGIN 400
+
+/**
+ * Same as `evaluate`, but only computes material and piece-square values
+ * when they alone put the score at least LAZY_EVAL_MARGIN outside the
+ * (`alpha`, `beta`) window, and returns that partial score (only accurate
+ * to within the margin) instead. Scores closer to the window are computed in full.
+ */
+extern int evaluate_lazy(struct board *board, enum color color, int alpha, int beta);
 
 /**
  * Returns the number of legal moves available.
  * 
- * Used to determine the final MOBILITY_BONUS bonus score.
+ * Used to determine the final mobility bonus score.
  */
 extern int get_mobility(struct board *board, enum color color);
 
 /**
  * Returns the number of pawns shielding the king of the given color.
  * 
- * Used to determine the final KIGN_PAWN_SHIELD_BONUS bonus score.
+ * Used to determine the final king pawn shield bonus score.
  */
 extern int get_pawns_shielding_king(struct board *board, enum color color);
 
+/**
+ * Returns the material hash table entry of the given board, computing its terms
+ * if they are not cached. Without a material hash table `entry` is filled in.
+ */
+extern const struct material_entry * probe_material(struct board *board, struct material_entry *entry);
+
 /**
  * Returns true if the player with the color `color` has at least one
  * bishop on a WHITE square and at least one bishop on a BLACK SQUARE.
  * 
- * Used to determine whether the BISHOP_PAIR_BONUS applies or not.
+ * Used to determine whether the bishop pair bonus applies or not.
  */
 extern bool has_bishop_pair(struct board *board, enum color color);
 
 /**
  * Returns the number of rooks of the given color on open files.
  * 
- * Used to determine the final ROOK_OPEN_FILE_BONUS bonus score.
+ * Used to determine the final rook open file bonus score.
  */
 extern int get_rooks_on_open_files(struct board *board, enum color color);
 
 /**
  * Returns the number of isolated pawns of the given color.
  * 
- * Used to determine the final ISOLATED_PAWN_PENALTY penalty to the score.
+ * Used to determine the final isolated pawn penalty to the score.
  */
 extern int get_isolated_pawns(struct board *board, enum color color);
 
 /**
  * Returns the number of doubled pawns of the given color.
  * 
- * Used to determine the final DOUBLED_PAWN_PENALTY penalty to the score.
+ * Used to determine the final doubled pawn penalty to the score.
  * 
  * Double pawns are defined as two or more pawns on a single file.
  * For example if FILE_B has one pawn - then it has 0 double pawns, if it has
@@ -119,7 +203,7 @@ extern int get_doubled_pawns(struct board *board, enum color color);
 /**
  * Return the number of the backward pawns of the given color.
  * 
- * Used to determine the final BACKWARD_PAWN_PENALTY penalty to the score.
+ * Used to determine the final backward pawn penalty to the score.
  * 
  * Backward pawns are pawns that are behind all the other pawns of the same color
  * on adjacent files and cannot be safely advanced.
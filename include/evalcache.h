@@ -0,0 +1,69 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "zobrist.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Default and maximum size of the evaluation cache in MB
+ * (a size of 0 disables the cache).
+ */
+#define EC_SIZE_DEFAULT 4
+#define EC_SIZE_MAX 1024
+
+/**
+ * Initialize the evaluation cache with the default size.
+ */
+void ec_init(void);
+
+/**
+ * Free memory occupied by the evaluation cache.
+ */
+void ec_term(void);
+
+/**
+ * Resize the evaluation cache to (at most) the given number of MB,
+ * dropping its entries and resetting its statistics.
+ * Must not be called while a search is running.
+ */
+void ec_resize(size_t size);
+
+/**
+ * Remove all entries from the evaluation cache and reset its statistics.
+ */
+void ec_clear(void);
+
+/**
+ * Look up the static evaluation (from the point of view of the side to move)
+ * stored for the provided key and copy it into `score`.
+ * Returns `false` if no such evaluation is stored.
+ * The cache may be probed and updated concurrently by several threads.
+ */
+bool ec_probe(zb_key_t key, int *score);
+
+/**
+ * Start loading the slot of the provided key into the CPU cache, so that
+ * probing it right after (e.g. once a move has been made) does not stall.
+ */
+void ec_prefetch(zb_key_t key);
+
+/**
+ * Store the static evaluation of the position with the provided key.
+ */
+void ec_store(zb_key_t key, int score);
+
+/**
+ * Add the hits and misses counted by the current thread to the statistics
+ * of the cache (threads count them locally to avoid sharing counters).
+ */
+void ec_flush_stats(void);
+
+/**
+ * Get the number of probes that found (`hits`) or did not find (`misses`)
+ * an evaluation since the cache was last cleared, as flushed by the threads.
+ */
+void ec_get_stats(unsigned long long *hits, unsigned long long *misses);
+
+#endif // EVALCACHE_H
@@ -0,0 +1,79 @@
+// Generated by `han-chesu params-header` (see `ep_print_header`), do not edit.
+
+.piece_values[PAWN] = 100,
+.piece_values[KNIGHT] = 350,
+.piece_values[BISHOP] = 375,
+.piece_values[ROOK] = 500,
+.piece_values[QUEEN] = 1000,
+.mobility_bonus = SCORE(1, 1),
+.king_pawn_shield_bonus = SCORE(7, 0),
+.bishop_pair_bonus = SCORE(10, 10),
+.rook_open_file_bonus = SCORE(15, 15),
+.knight_pawn_bonus = SCORE(6, 6),
+.isolated_pawn_penalty = SCORE(-30, -30),
+.doubled_pawn_penalty = SCORE(-25, -25),
+.backward_pawn_penalty = SCORE(-20, -20),
+.rook_pawn_penalty = SCORE(-12, -12),
+.passed_pawn_bonus = {
+    SCORE(0, 0), SCORE(5, 10), SCORE(5, 15), SCORE(10, 25), SCORE(25, 45), SCORE(45, 80), SCORE(70, 120), SCORE(0, 0),
+},
+.pst[PAWN] = {
+    SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0),
+    SCORE(50, 80), SCORE(50, 80), SCORE(50, 80), SCORE(50, 80), SCORE(50, 80), SCORE(50, 80), SCORE(50, 80), SCORE(50, 80),
+    SCORE(10, 50), SCORE(10, 50), SCORE(20, 50), SCORE(30, 50), SCORE(30, 50), SCORE(20, 50), SCORE(10, 50), SCORE(10, 50),
+    SCORE(5, 30), SCORE(5, 30), SCORE(10, 30), SCORE(25, 30), SCORE(25, 30), SCORE(10, 30), SCORE(5, 30), SCORE(5, 30),
+    SCORE(0, 15), SCORE(0, 15), SCORE(0, 15), SCORE(20, 15), SCORE(20, 15), SCORE(0, 15), SCORE(0, 15), SCORE(0, 15),
+    SCORE(5, 5), SCORE(-5, 5), SCORE(-10, 5), SCORE(0, 5), SCORE(0, 5), SCORE(-10, 5), SCORE(-5, 5), SCORE(5, 5),
+    SCORE(5, 0), SCORE(10, 0), SCORE(10, 0), SCORE(-20, 0), SCORE(-20, 0), SCORE(10, 0), SCORE(10, 0), SCORE(5, 0),
+    SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0),
+},
+.pst[KNIGHT] = {
+    SCORE(-50, -50), SCORE(-40, -40), SCORE(-30, -30), SCORE(-30, -30), SCORE(-30, -30), SCORE(-30, -30), SCORE(-40, -40), SCORE(-50, -50),
+    SCORE(-40, -40), SCORE(-20, -20), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-20, -20), SCORE(-40, -40),
+    SCORE(-30, -30), SCORE(0, 0), SCORE(10, 10), SCORE(15, 15), SCORE(15, 15), SCORE(10, 10), SCORE(0, 0), SCORE(-30, -30),
+    SCORE(-30, -30), SCORE(5, 5), SCORE(15, 15), SCORE(20, 20), SCORE(20, 20), SCORE(15, 15), SCORE(5, 5), SCORE(-30, -30),
+    SCORE(-30, -30), SCORE(0, 0), SCORE(15, 15), SCORE(20, 20), SCORE(20, 20), SCORE(15, 15), SCORE(0, 0), SCORE(-30, -30),
+    SCORE(-30, -30), SCORE(5, 5), SCORE(10, 10), SCORE(15, 15), SCORE(15, 15), SCORE(10, 10), SCORE(5, 5), SCORE(-30, -30),
+    SCORE(-40, -40), SCORE(-20, -20), SCORE(0, 0), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(-20, -20), SCORE(-40, -40),
+    SCORE(-50, -50), SCORE(-40, -40), SCORE(-30, -30), SCORE(-30, -30), SCORE(-30, -30), SCORE(-30, -30), SCORE(-40, -40), SCORE(-50, -50),
+},
+.pst[BISHOP] = {
+    SCORE(-20, -20), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-20, -20),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(5, 5), SCORE(10, 10), SCORE(10, 10), SCORE(5, 5), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(5, 5), SCORE(5, 5), SCORE(10, 10), SCORE(10, 10), SCORE(5, 5), SCORE(5, 5), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(5, 5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(5, 5), SCORE(-10, -10),
+    SCORE(-20, -20), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-10, -10), SCORE(-20, -20),
+},
+.pst[ROOK] = {
+    SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0),
+    SCORE(5, 5), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(10, 10), SCORE(5, 5),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0),
+},
+.pst[QUEEN] = {
+    SCORE(-20, -20), SCORE(-10, -10), SCORE(-10, -10), SCORE(-5, -5), SCORE(-5, -5), SCORE(-10, -10), SCORE(-10, -10), SCORE(-20, -20),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-5, -5), SCORE(0, 0), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(0, 0), SCORE(0, 0), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(-5, -5),
+    SCORE(-10, -10), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(5, 5), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-10, -10), SCORE(0, 0), SCORE(5, 5), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(-10, -10),
+    SCORE(-20, -20), SCORE(-10, -10), SCORE(-10, -10), SCORE(-5, -5), SCORE(-5, -5), SCORE(-10, -10), SCORE(-10, -10), SCORE(-20, -20),
+},
+.pst[KING] = {
+    SCORE(-30, -50), SCORE(-40, -40), SCORE(-40, -30), SCORE(-50, -20), SCORE(-50, -20), SCORE(-40, -30), SCORE(-40, -40), SCORE(-30, -50),
+    SCORE(-30, -30), SCORE(-40, -20), SCORE(-40, -10), SCORE(-50, 0), SCORE(-50, 0), SCORE(-40, -10), SCORE(-40, -20), SCORE(-30, -30),
+    SCORE(-30, -30), SCORE(-40, -10), SCORE(-40, 20), SCORE(-50, 30), SCORE(-50, 30), SCORE(-40, 20), SCORE(-40, -10), SCORE(-30, -30),
+    SCORE(-30, -30), SCORE(-40, -10), SCORE(-40, 30), SCORE(-50, 40), SCORE(-50, 40), SCORE(-40, 30), SCORE(-40, -10), SCORE(-30, -30),
+    SCORE(-20, -30), SCORE(-30, -10), SCORE(-30, 30), SCORE(-40, 40), SCORE(-40, 40), SCORE(-30, 30), SCORE(-30, -10), SCORE(-20, -30),
+    SCORE(-10, -30), SCORE(-20, -10), SCORE(-20, 20), SCORE(-20, 30), SCORE(-20, 30), SCORE(-20, 20), SCORE(-20, -10), SCORE(-10, -30),
+    SCORE(20, -30), SCORE(20, -30), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(0, 0), SCORE(20, -30), SCORE(20, -30),
+    SCORE(20, -50), SCORE(30, -30), SCORE(10, -30), SCORE(0, -30), SCORE(0, -30), SCORE(10, -30), SCORE(30, -30), SCORE(20, -50),
+},
@@ -0,0 +1,101 @@
+#ifndef EVALPARAMS_H
+#define EVALPARAMS_H
+
+#include "board.h"
+#include "score.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * Weights of the hand-tuned evaluation. Bonuses and penalties are packed
+ * midgame and endgame values (see `score.h`); piece values count the same
+ * in both phases.
+ */
+struct eval_params {
+    int piece_values[PIECE_CNT]; // the king has no value
+
+    score_t mobility_bonus;
+    score_t king_pawn_shield_bonus;
+    score_t bishop_pair_bonus;
+    score_t rook_open_file_bonus;
+    score_t knight_pawn_bonus; // per own pawn above 5 (knights gain value in closed positions)
+
+    score_t isolated_pawn_penalty;
+    score_t doubled_pawn_penalty;
+    score_t backward_pawn_penalty;
+    score_t rook_pawn_penalty; // per own pawn above 5 (rooks lose value in closed positions)
+
+    score_t passed_pawn_bonus[RK_CNT]; // by rank (from the point of view of the pawn color)
+
+    // piece-square tables, laid out as seen from WHITE's side with rank 8
+    // on the first row (the initial values are taken from
+    // https://www.chessprogramming.org/Simplified_Evaluation_Function)
+    score_t pst[PIECE_CNT][SQ_CNT];
+};
+
+/**
+ * Largest magnitude of a parameter value (packed values are 16-bit).
+ */
+#define EP_VALUE_MAX 10000
+
+#ifdef TUNE
+
+/**
+ * Parameters used by the evaluation. Tuning builds (`TUNE=1`) can change
+ * them at runtime; they start with the values the engine was built with.
+ */
+extern struct eval_params eval_params;
+
+/**
+ * Load the parameters listed in the parameter file at the given path
+ * (see `ep_print`), keeping the others (an empty path restores the values
+ * the engine was built with). Returns `false` (changing none) if it is invalid.
+ *
+ * The pawn, material and evaluation caches as well as the piece-square sums
+ * of existing boards (see `board_update_pst`) hold values of the previous
+ * parameters and must be refreshed by the caller.
+ */
+bool ep_load(const char *path);
+
+/**
+ * Check if the given name is the one of a parameter (see `ep_set`).
+ */
+bool ep_exists(const char *name);
+
+/**
+ * Set the parameter with the given name to the given whitespace separated
+ * values (as in a parameter file). `Name[i]` only sets value `i` of the
+ * parameter, e.g. `PawnPst[3]` is the endgame value of the second square.
+ * Returns `false` (changing nothing) if the name or values are invalid.
+ * The caller must refresh the caches as after `ep_load`.
+ */
+bool ep_set(const char *name, const char *values);
+
+#else
+
+/**
+ * Parameters used by the evaluation. Release builds have them baked in
+ * as constants from the generated header (see `ep_print_header`),
+ * so that the compiler folds them into the evaluation code.
+ */
+static const struct eval_params eval_params = {
+#include "evalparams-gen.h"
+};
+
+#endif
+
+/**
+ * Print the parameters as a parameter file: one line per parameter with its
+ * name followed by its values, the midgame and endgame values of each packed
+ * score one after the other (lines starting with '#' are comments).
+ */
+void ep_print(FILE *file);
+
+/**
+ * Print the parameters as the initializer included by `evalparams.h`
+ * (`include/evalparams-gen.h`), from which release builds take them.
+ */
+void ep_print_header(FILE *file);
+
+#endif // EVALPARAMS_H
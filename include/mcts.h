@@ -0,0 +1,77 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <stddef.h>
+
+/**
+ * Number of nodes in the node pool of the tree.
+ */
+#define MCTS_NODE_CNT (1 << 20)
+
+/**
+ * Maximum number of plies a playout descends into the tree.
+ */
+#define MCTS_PLY_MAX 64
+
+/**
+ * Depth of the alpha-beta probe evaluating a new leaf
+ * (0 evaluates it with quiescence search only).
+ */
+#define MCTS_PROBE_DEPTH 1
+
+/**
+ * Exploration constant of the PUCT formula (in thousandths).
+ */
+#define MCTS_CPUCT 1500
+
+/**
+ * Reduction of the first play urgency of unvisited nodes (in thousandths).
+ */
+#define MCTS_FPU_REDUCTION 200
+
+/**
+ * Scale (in centipawns) of the logistic function mapping scores to values
+ * and of the softmax computing move priors from their static evaluation.
+ */
+#define MCTS_SCORE_SCALE 200
+#define MCTS_PRIOR_SCALE 100
+
+/**
+ * Free memory occupied by the node pool.
+ */
+void mcts_term(void);
+
+/**
+ * Start a new tree for the given position whose root children are the given
+ * moves (allocating the node pool the first time).
+ */
+void mcts_reset(struct board *board, const struct move_list *moves);
+
+/**
+ * Grow the tree with playouts until the search is stopped or the node pool
+ * is exhausted. Each playout selects a leaf by the PUCT formula, expands it
+ * and evaluates it with a shallow alpha-beta probe instead of a random game.
+ * Several threads may grow the tree at once, each with its own ordering info;
+ * nodes on the path of a running playout get a virtual loss so that the
+ * other threads spread out over the tree.
+ */
+void mcts_run(struct board *board, struct ordering_info *ordering_info);
+
+/**
+ * Get the number of playouts made since the tree was reset.
+ */
+unsigned long long mcts_get_playouts(void);
+
+/**
+ * Store into `pv` the line of most visited moves starting with the `rank`-th
+ * most visited root move and into `score` its score in centipawns.
+ * Returns the length of the line (0 if there is no such root move).
+ */
+size_t mcts_get_pv(size_t rank, struct move pv[SEARCH_PV_LEN_MAX], int *score);
+
+#endif // MCTS_H
@@ -1,6 +1,8 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include <stdbool.h>
+
 /**
  * Value representing a move flag.
  */
@@ -30,4 +32,15 @@ struct move {
     int score;
 };
 
+/**
+ * Check whether two moves are the same, ignoring their scores.
+ */
+static inline bool move_equal(struct move m1, struct move m2) {
+    // the capture and promotion fields are only meaningful
+    // when the corresponding flags are set
+    return m1.flags == m2.flags && m1.from == m2.from && m1.to == m2.to && m1.piece == m2.piece
+        && (!(m1.flags & MOVE_FLAG_CAPTURE) || m1.capture == m2.capture)
+        && (!(m1.flags & MOVE_FLAG_PROMOTION) || m1.promotion == m2.promotion);
+}
+
 #endif // MOVE_H
@@ -4,6 +4,7 @@
 #include "board.h"
 #include "move.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /**
@@ -25,10 +26,37 @@ struct move_list {
     size_t captured_pieces;
 };
 
+/**
+ * Value representing a subset of the possible moves.
+ */
+enum movegen_type {
+    MOVEGEN_ALL,      // all moves
+    MOVEGEN_CAPTURES, // captures and promotions
+    MOVEGEN_QUIETS,   // all other moves
+};
+
 /**
  * Populate the provided move list for the provided board
  * with all the possible moves.
  */
 void movegen_add_moves(struct move_list *moves, struct board *board);
 
+/**
+ * Populate the provided move list for the provided board
+ * with all the possible captures and promotions.
+ */
+void movegen_add_captures(struct move_list *moves, struct board *board);
+
+/**
+ * Populate the provided move list for the provided board
+ * with all the possible moves that are neither captures nor promotions.
+ */
+void movegen_add_quiets(struct move_list *moves, struct board *board);
+
+/**
+ * Verify if the provided move (possibly coming from another
+ * game state) is legal for the provided board.
+ */
+bool movegen_is_legal(struct board *board, struct move move);
+
 #endif // MOVEGEN_H
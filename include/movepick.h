@@ -0,0 +1,83 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Value representing the stage a move picker is in.
+ * Moves of a stage are only generated once all the
+ * moves of the previous stages have been picked.
+ */
+enum mp_stage {
+    MP_STAGE_HASH,           // move from the transposition table
+    MP_STAGE_CAPTURES_INIT,  // generate and score captures and promotions
+    MP_STAGE_GOOD_CAPTURES,  // captures that do not lose material, by score
+    MP_STAGE_REFUTATIONS,    // killer moves and counter move
+    MP_STAGE_QUIETS_INIT,    // generate and score quiet moves
+    MP_STAGE_QUIETS,         // quiet moves, by history score
+    MP_STAGE_BAD_CAPTURES,   // captures that lose material
+    MP_STAGE_DONE,
+
+    MP_STAGE_CNT, // number of stages
+};
+
+/**
+ * Number of refutation moves (2 killers and a counter move).
+ */
+#define MP_REFUTATION_CNT 3
+
+struct move_picker {
+    struct board *board;
+    struct ordering_info *ordering_info; // `NULL` if no ordering info is available
+
+    enum mp_stage stage;
+
+    bool captures_only; // stop after the good captures (used by quiescence search)
+    bool skip_quiets; // skip the quiet moves not picked yet (used by late move pruning)
+
+    struct move hash_move;
+
+    struct move refutations[MP_REFUTATION_CNT];
+    size_t refutation_idx;
+
+    struct move_list captures;
+    size_t bad_captures_cnt; // bad captures are kept at the front of `captures`
+
+    struct move_list quiets;
+};
+
+/**
+ * Initialize a move picker for picking all the legal moves of a board.
+ * The killers of the search stack frame `ss` and the counter move of the
+ * previous move (the one of `ss-1`) are tried before the other quiet moves
+ * if `ordering_info` is provided.
+ */
+void mp_init(struct move_picker *mp, struct board *board,
+             struct ordering_info *ordering_info,
+             const struct search_stack *ss, struct move hash_move);
+
+/**
+ * Initialize a move picker for picking only the captures and promotions
+ * of a board which do not lose material.
+ */
+void mp_init_captures(struct move_picker *mp, struct board *board);
+
+/**
+ * Skip the quiet moves (killers and counter move included) that have not
+ * been picked yet; quiet moves that have not been generated yet never are.
+ */
+void mp_skip_quiets(struct move_picker *mp);
+
+/**
+ * Pick the next move. Returns a move with `MOVE_FLAG_INVALID` as flags
+ * once all the moves have been picked.
+ */
+struct move mp_next(struct move_picker *mp);
+
+#endif // MOVEPICK_H
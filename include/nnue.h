@@ -0,0 +1,95 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "board.h"
+#include "zobrist.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Version of the network file format (see `nnue_load`).
+ */
+#define NNUE_VERSION 1
+
+/**
+ * Number of input features of each perspective (HalfKP): one per square of
+ * the king of the perspective, square and piece other than a king (of either
+ * color). Squares are seen from the perspective (flipped vertically for BLACK)
+ * and the feature of a piece is `(king_sq*10 + 2*piece + other)*64 + sq`,
+ * pieces going from pawn to queen and `other` telling the opponent ones.
+ */
+#define NNUE_INPUTS (SQ_CNT * 10 * SQ_CNT)
+
+/**
+ * Number of neurons of the layers of the network. The accumulators of both
+ * perspectives (side to move first) make the input of the first hidden layer.
+ */
+#define NNUE_HALF_DIMS 256
+#define NNUE_HIDDEN1_DIMS 32
+#define NNUE_HIDDEN2_DIMS 32
+
+/**
+ * Number of accumulators (must be a power of 2) of an accumulator table.
+ */
+#define NNUE_TABLE_CNT (1 << 8)
+
+/**
+ * First layer outputs (feature transformer) of both perspectives of a position.
+ */
+struct nnue_accumulator {
+    int16_t values[COLOR_CNT][NNUE_HALF_DIMS];
+
+    zb_key_t key; // key of the position (ZB_KEY_EMPTY if not computed)
+    unsigned network; // number of the network load that computed the accumulator
+};
+
+/**
+ * Detect the SIMD instructions supported by the CPU and select the fastest
+ * inference kernels they allow.
+ */
+void nnue_init(void);
+
+/**
+ * Free memory occupied by the loaded network.
+ */
+void nnue_term(void);
+
+/**
+ * Load the network stored in the file at the given path, replacing the loaded
+ * one (an empty path unloads it). The file starts with the "HCNN" magic, the
+ * format version and the layer sizes (32-bit little-endian integers, which
+ * must match the ones above), followed by the little-endian parameters:
+ * the 16-bit feature transformer biases and weights (by feature), then for
+ * each of the hidden and output layers the 32-bit biases and 8-bit weights
+ * (by output neuron). Returns `false` (keeping no network) if it is invalid.
+ */
+bool nnue_load(const char *path);
+
+/**
+ * Check if a network is loaded, in which case it replaces
+ * the hand-tuned evaluation.
+ */
+bool nnue_is_loaded(void);
+
+/**
+ * Get the name of the SIMD instructions used by the inference kernels.
+ */
+const char * nnue_get_simd(void);
+
+/**
+ * Set the accumulator table (`NNUE_TABLE_CNT` entries, zeroed before first
+ * use) of the current thread. Accumulators are kept in it by position key and
+ * updated from the one of the position before the last move when it is still
+ * there, otherwise they are computed from scratch. Every thread needs its own
+ * table; without one every evaluation computes the accumulators from scratch.
+ */
+void nnue_set_table(struct nnue_accumulator *table);
+
+/**
+ * Evaluate the board with the loaded network from the point of view
+ * of the given color (in centipawns).
+ */
+int nnue_evaluate(struct board *board, enum color color);
+
+#endif // NNUE_H
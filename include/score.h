@@ -0,0 +1,39 @@
+#ifndef SCORE_H
+#define SCORE_H
+
+#include <stdint.h>
+
+/**
+ * A score packs a midgame and an endgame value (in centipawns) into a single
+ * integer, the endgame one in the upper half, so that both are added,
+ * subtracted and multiplied by integers at once.
+ */
+typedef int32_t score_t;
+
+/**
+ * Pack a midgame and an endgame value into a score
+ * (a constant expression for constant values).
+ */
+#define SCORE(mg, eg) ((score_t)((uint32_t)(eg) << 16) + (mg))
+
+/**
+ * Zero score.
+ */
+#define SCORE_ZERO SCORE(0, 0)
+
+/**
+ * Extract the midgame value of a score.
+ */
+static inline int score_mg(score_t s) {
+    return (int16_t)(uint16_t)(uint32_t)s;
+}
+
+/**
+ * Extract the endgame value of a score (the upper half is rounded
+ * since a negative midgame value borrows from it).
+ */
+static inline int score_eg(score_t s) {
+    return (int16_t)(uint16_t)(((uint32_t)s + 0x8000) >> 16);
+}
+
+#endif // SCORE_H
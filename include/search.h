@@ -3,10 +3,203 @@
 
 #include "board.h"
 #include "move.h"
+#include "movegen.h"
 
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Default depth limit of a search.
+ */
 #define SEARCH_DEPTH 6
 
+/**
+ * Maximum depth limit of a search.
+ */
+#define SEARCH_DEPTH_MAX 64
+
+/**
+ * Maximum number of plies from the root reached by the main search
+ * (the size of the search stack); deeper nodes are evaluated statically.
+ */
+#define SEARCH_PLY_MAX 128
+
+/**
+ * Number of sentinel frames before the root frame of the search stack,
+ * so that the frames of the two previous plies can be accessed at any ply.
+ */
+#define SEARCH_STACK_OFFSET 2
+
+/**
+ * Static evaluation of a node that has not been evaluated
+ * (nodes in check are not evaluated).
+ */
+#define SEARCH_EVAL_NONE INT_MIN
+
+/**
+ * Default time limit of a search (in milliseconds).
+ */
+#define SEARCH_TIME_LIMIT 5000
+
+/**
+ * Maximum number of threads searching in parallel.
+ */
+#define SEARCH_THREADS_MAX 64
+
+/**
+ * Number of nodes a thread visits between two checks of the search limits
+ * (must be a power of 2).
+ */
+#define SEARCH_CHECK_NODES 1024
+
+/**
+ * Minimum depth at which moves searched by another thread are deferred.
+ */
+#define SEARCH_DEFER_DEPTH 3
+
+/**
+ * Number of buckets (must be a power of 2) and ways per bucket
+ * of the table of moves currently being searched.
+ */
+#define SEARCH_CS_CNT (1 << 15)
+#define SEARCH_CS_WAYS 4
+
+/**
+ * Minimum depth at which nodes without a hash move are searched
+ * one ply shallower (internal iterative reductions).
+ */
+#define SEARCH_IIR_DEPTH 4
+
+/**
+ * Minimum depth, margin over beta and depth reduction of ProbCut: good
+ * captures of deep nodes are searched shallower against the raised beta
+ * and, if they still fail high, the node is pruned.
+ */
+#define SEARCH_PROBCUT_DEPTH 5
+#define SEARCH_PROBCUT_MARGIN 200
+#define SEARCH_PROBCUT_REDUCTION 4
+
+/**
+ * Maximum depth at which quiet moves are pruned once enough of them
+ * have been searched (late move pruning).
+ */
+#define SEARCH_LMP_DEPTH 3
+
+/**
+ * Minimum depth at which the hash move is tested for singularity.
+ */
+#define SEARCH_SINGULAR_DEPTH 4
+
+/**
+ * Margin (per ply of depth) by which all the other moves must fail
+ * below the hash move score for the hash move to be singular.
+ */
+#define SEARCH_SINGULAR_MARGIN 25
+
+/**
+ * Margin added to the material gained by a capture in quiescence search;
+ * captures that cannot raise alpha even with this margin are pruned.
+ */
+#define SEARCH_DELTA_MARGIN 200
+
+/**
+ * Maximum number of plies searched by quiescence search
+ * (bounds check evasion sequences).
+ */
+#define SEARCH_QUIESCENCE_PLY_MAX 32
+
+/**
+ * Maximum number of principal variations searched in multi-PV mode.
+ */
+#define SEARCH_MULTI_PV_MAX 64
+
+/**
+ * Maximum number of moves reported in a principal variation.
+ */
+#define SEARCH_PV_LEN_MAX 32
+
+/**
+ * Score beyond which a score is reported as a mate.
+ */
+#define SEARCH_MATE_BOUND (INT_MAX / 4)
+
+/**
+ * Value representing the algorithm used for searching the root moves.
+ */
+enum search_algorithm {
+    SEARCH_ALGORITHM_PVS,  // principal variation search with a full window
+    SEARCH_ALGORITHM_MTDF, // repeated zero-window searches (MTD(f))
+    SEARCH_ALGORITHM_MCTS, // Monte Carlo tree search with alpha-beta probes
+    SEARCH_ALGORITHM_DFPN, // proof-number mate search (df-pn), PVS if no mate is found
+
+    SEARCH_ALGORITHM_CNT, // number of search algorithms
+
+    SEARCH_ALGORITHM_UNKNOWN = -1,
+};
+
+/**
+ * Mapping of search algorithms to their string representations.
+ */
+extern const char *search_algorithm_strs[SEARCH_ALGORITHM_CNT];
+
+/**
+ * Convert string to a search algorithm.
+ */
+enum search_algorithm search_str_to_algorithm(const char *str);
+
+/**
+ * Options controlling how the best move is searched.
+ */
+struct search_options {
+    enum search_algorithm algorithm;
+
+    int depth; // maximum depth searched (maximum number of moves of a mate for df-pn)
+    int time_limit; // maximum time spent searching in milliseconds (0 for no limit)
+    int nps; // nodes per second the time is measured in (0 for wall clock time)
+    int threads; // number of threads searching in parallel
+    bool (*stop_poll)(void); // polled along with the time, stops the search once it returns `true` (`NULL` for none)
+
+    int multi_pv; // number of best root moves searched with exact scores
+    bool post; // whether thinking output is sent to xboard
+
+    struct move excluded[MOVE_LIST_MAX]; // root moves that are not searched
+    size_t excluded_cnt;
+};
+
+/**
+ * Statistics gathered by a search.
+ */
+struct search_stats {
+    unsigned long long nodes; // number of nodes visited
+    int passes; // number of root searches (several per line for MTD(f), playouts for MCTS)
+    int depth; // depth of the last completed iteration
+    int score; // score of the best move
+};
+
+/**
+ * Check whether the current search has to stop.
+ */
+bool search_stopped(void);
+
+/**
+ * Make all the threads of the current search stop.
+ */
+void search_stop(void);
+
+/**
+ * Count a node visited by the current thread and check whether the
+ * current search has to stop, for root algorithms with their own nodes.
+ */
+bool search_check_limits(void);
+
+/**
+ * Check whether the given root move is excluded from the search.
+ */
+bool search_is_excluded(const struct search_options *options, struct move move);
+
 enum other_score {
+    HASH_MOVE_BONUS = 5000,
     CAPTURE_BONUS = 4000,
     PROMOTION_BONUS = 3000,
     KILLER1_BONUS = 2000,
@@ -14,13 +207,59 @@ enum other_score {
     QUIET_BONUS = 0
 };
 
+/**
+ * Frame of the search stack holding the state of a node of the current path.
+ * A node reaches the frames of its ancestors through `ss-1`, `ss-2` and so on
+ * and the frame of its child through `ss+1`.
+ */
+struct search_stack {
+    int ply; // distance from the root
+
+    struct move killers[2]; // quiet moves that caused a cutoff at this ply
+    struct move current; // move being searched
+    struct move excluded; // move skipped (used by singular extensions)
+
+    int static_eval; // `SEARCH_EVAL_NONE` if not evaluated
+    bool in_check;
+};
+
 struct ordering_info {
-    struct move killer1[50], killer2[50];
-    int ply;
+    struct search_stack stack[SEARCH_STACK_OFFSET + SEARCH_PLY_MAX + 1]; // the root frame is at `SEARCH_STACK_OFFSET`
+    struct move counter[COLOR_CNT][PIECE_CNT][SQ_CNT]; // quiet move refuting the last move of a color
+    int depth; // depth of the current iteration
+    int extensions; // number of plies extended on the current path
     int history[2][64][64];
 };
 
-struct move search_best_move(struct board *board);
+/**
+ * Evaluate a position of the current search with a full-window alpha-beta
+ * search of the given depth (quiescence search only for depth 0), for root
+ * algorithms that need a score for their leaves.
+ */
+int search_probe(struct board *board, int depth, struct ordering_info *ordering_info);
+
+/**
+ * MVV-LVA scores indexed by captured piece and capturing piece.
+ */
+extern int other_attacks_table[PIECE_CNT][PIECE_CNT];
+
+/**
+ * Free memory occupied by the pawn and material hash tables of the search threads.
+ */
+void search_term(void);
+
+/**
+ * Search the best move in the given position, skipping the excluded root moves
+ * (an invalid move is returned if all of them are excluded).
+ * In multi-PV mode the `options->multi_pv` best moves are searched one after
+ * the other, each with the previously found ones excluded from the root, and
+ * each is reported with its own score and principal variation.
+ * With several threads, all of them search the position and share their results
+ * through the hash table; a thread skips moves that the others are searching
+ * after it has searched the first move of a node (simplified ABDADA).
+ * If `stats` is not `NULL` it receives the statistics of the search.
+ */
+struct move search_best_move(struct board *board, const struct search_options *options, struct search_stats *stats);
 struct move search_best_move2(struct board *board);
 void init_other_moves_table();
 
@@ -0,0 +1,68 @@
+#ifndef TT_H
+#define TT_H
+
+#include "move.h"
+#include "zobrist.h"
+
+#include <stdbool.h>
+
+/**
+ * Number of entries in the transposition table (must be a power of 2).
+ */
+#define TT_ENTRY_CNT (1 << 20)
+
+/**
+ * Value representing the kind of bound stored for a score.
+ */
+enum tt_bound {
+    TT_BOUND_UPPER, // score failed low (real score <= stored score)
+    TT_BOUND_LOWER, // score failed high (real score >= stored score)
+    TT_BOUND_EXACT, // score is exact
+
+    TT_BOUND_CNT, // number of bounds
+
+    TT_BOUND_NONE = -1,
+};
+
+/**
+ * Structure representing a transposition table entry.
+ */
+struct tt_entry {
+    zb_key_t key;
+
+    struct move move; // best move found (`MOVE_FLAG_INVALID` if none)
+
+    int score;
+    int depth;
+
+    enum tt_bound bound;
+};
+
+/**
+ * Initialize the transposition table.
+ */
+void tt_init(void);
+
+/**
+ * Free memory occupied by the transposition table.
+ */
+void tt_term(void);
+
+/**
+ * Remove all entries from the transposition table.
+ */
+void tt_clear(void);
+
+/**
+ * Look up the entry stored for the provided key and copy it into `entry`.
+ * Returns `false` if no such entry exists.
+ * The table may be probed and updated concurrently by several threads.
+ */
+bool tt_probe(zb_key_t key, struct tt_entry *entry);
+
+/**
+ * Store a search result for the provided key.
+ */
+void tt_store(zb_key_t key, struct move move, int score, int depth, enum tt_bound bound);
+
+#endif // TT_H
@@ -68,6 +68,7 @@ enum xb_in_cmd {
     XB_IN_CMD_POST,
     XB_IN_CMD_NOPOST,
     XB_IN_CMD_ANALYZE,
+    XB_IN_CMD_EXIT,
 
     // activated by `XB_FEATURE_NAME`
     // (default: `true` when playing on chess server)
@@ -116,6 +117,9 @@ enum xb_in_cmd {
     XB_IN_CMD_PUT,
     XB_IN_CMD_HOVER,
 
+    // engine specific (not part of the protocol)
+    XB_IN_CMD_BENCH,
+
     XB_IN_CMD_CNT, // number of input commands
 
     XB_IN_CMD_UNKNOWN = -1,
@@ -189,6 +189,54 @@ extern const char *xb_result_strs[XB_RESULT_CNT];
  */
 enum xb_result xb_str_to_result(const char *str);
 
+/**
+ * Value representing an engine option configurable through
+ * the `XB_IN_CMD_OPTION` command.
+ */
+enum xb_option {
+    // type: spin
+    // default: 1
+    XB_OPTION_MULTI_PV,
+
+    // type: combo
+    // default: "PVS"
+    XB_OPTION_SEARCH,
+
+    // type: spin
+    // default: `EC_SIZE_DEFAULT`
+    XB_OPTION_EVAL_CACHE,
+
+    // type: file
+    // default: "" (hand-tuned evaluation)
+    XB_OPTION_EVAL_FILE,
+
+#ifdef TUNE
+    // type: file
+    // default: "" (parameters the engine was built with)
+    XB_OPTION_EVAL_PARAMS,
+#endif
+
+    XB_OPTION_CNT, // number of options
+
+    XB_OPTION_UNKNOWN = -1,
+};
+
+/**
+ * Mapping of engine options to their names.
+ */
+extern const char *xb_option_strs[XB_OPTION_CNT];
+
+/**
+ * Mapping of engine options to the control descriptions
+ * announced to xboard through the `XB_FEATURE_OPTION` feature.
+ */
+extern const char *xb_option_descs[XB_OPTION_CNT];
+
+/**
+ * Convert string to an engine option.
+ */
+enum xb_option xb_str_to_option(const char *str);
+
 struct xboard {
     int protover;
 
@@ -214,6 +262,11 @@ void xb_init(void);
  */
 void xb_term(void);
 
+/**
+ * Check whether input from xboard is waiting to be read.
+ */
+bool xb_input_pending(void);
+
 /**
  * Read a string into automatically allocated space.
  * You should `free` the returned pointer after it is no longer needed.
@@ -232,6 +285,19 @@ char * xb_read_comment(const char *err_str);
  */
 char * xb_read_fen(const char *err_str);
 
+/**
+ * Read the rest of the current line into automatically allocated space.
+ * You should `free` the returned pointer after it is no longer needed.
+ */
+char * xb_read_line(const char *err_str);
+
+/**
+ * Read the rest of the current line into automatically allocated space,
+ * or return `NULL` if there is nothing left on it (optional arguments).
+ * You should `free` the returned pointer after it is no longer needed.
+ */
+char * xb_read_opt_line(void);
+
 /**
  * Read an integer.
  */
@@ -0,0 +1,63 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+
+/**
+ * A Zobrist key is a 64-bit word uniquely (modulo collisions)
+ * identifying a game state.
+ */
+typedef uint_fast64_t zb_key_t;
+
+#include "board.h"
+
+struct board;
+
+/**
+ * Empty key.
+ */
+extern const zb_key_t ZB_KEY_EMPTY;
+
+/**
+ * Random keys for each piece of each color on each square.
+ */
+extern zb_key_t zb_pieces[COLOR_CNT][PIECE_CNT][SQ_CNT];
+
+/**
+ * Random keys for each combination of castle rights.
+ */
+extern zb_key_t zb_castle_rights[CASTLE_RIGHT_ALL+1];
+
+/**
+ * Random keys for each en passant file.
+ */
+extern zb_key_t zb_en_passant[FL_CNT];
+
+/**
+ * Random key toggled when black is on move.
+ */
+extern zb_key_t zb_color;
+
+/**
+ * Initialize the random keys.
+ */
+void zb_init(void);
+
+/**
+ * Compute the key of the provided board from scratch.
+ */
+zb_key_t zb_get_key(struct board *board);
+
+/**
+ * Compute the key of the pawns of the provided board from scratch.
+ */
+zb_key_t zb_get_pawn_key(struct board *board);
+
+/**
+ * Compute the key of the piece counts of the provided board from scratch.
+ * The `i`-th piece of a type is hashed with the key of that piece on square `i`,
+ * so that adding or removing a piece is done with a single XOR.
+ */
+zb_key_t zb_get_material_key(struct board *board);
+
+#endif // ZOBRIST_H
@@ -0,0 +1,197 @@
+#include "bench.h"
+
+#include "board.h"
+#include "evalcache.h"
+#include "search.h"
+#include "tt.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+static const char *bench_fens[] = {
+    // openings
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "rnbqkb1r/p1pp1ppp/1p2pn2/8/2PP4/5N2/PP2PPPP/RNBQKB1R w KQkq - 0 4",
+    "r1bqk2r/pppp1ppp/2n2n2/2b1p3/2B1P3/2N2N2/PPPP1PPP/R1BQK2R w KQkq - 6 5",
+    "rnbqk2r/ppp1ppbp/3p1np1/8/2PPP3/2N5/PP3PPP/R1BQKBNR w KQkq - 1 5",
+    "rnbqkb1r/ppp2ppp/4pn2/3p4/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+    "r1bqkbnr/pp1ppppp/2n5/2p5/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+
+    // middlegames
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP2BPPP/R2QKB1R w KQ - 1 8",
+    "r2q1rk1/pp1nbppp/2p1pn2/3p1b2/2PP4/1PN1PN2/PB2BPPP/R2Q1RK1 w - - 3 9",
+    "2rq1rk1/pp1bppbp/3p1np1/4n3/3NP3/1BN1BP2/PPPQ2PP/2KR3R w - - 9 12",
+    "r1b2rk1/2q1bppp/p2ppn2/1p6/3BPP2/2N2B2/PPPQ2PP/2KR3R w - - 0 14",
+    "r2qr1k1/1p1nbppp/p2pbn2/4p3/4P3/1NN1BP2/PPPQ2PP/2KR1B1R w - - 4 12",
+    "r1bqr1k1/ppp2ppp/2np1n2/2b1p3/2B1P3/2PP1N2/PP1N1PPP/R1BQR1K1 w - - 1 8",
+    "r2q1rk1/1b2bppp/p1n1pn2/1p6/3P4/P1NB1N2/1P2QPPP/R1B2RK1 w - - 2 12",
+    "2kr3r/pp1q1ppp/2n1bn2/2bpp3/8/2PP1NP1/PP1NPPBP/R1BQ1RK1 w - - 4 10",
+    "r4rk1/pp2ppbp/2n3p1/q2p4/3P1B2/2P1PN2/P2Q1PPP/R3KB1R w KQ - 0 12",
+    "3r1rk1/p1q2ppp/1pn1pn2/2b5/2P5/P1N1PN2/1PQ1BPPP/3R1RK1 w - - 2 15",
+
+    // tactical
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "r1b1kb1r/3q1ppp/pBp1pn2/8/Np3P2/5B2/PPP3PP/R2Q1RK1 w kq - 0 1",
+    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1",
+    "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PPR/2KR4 w - - 0 1",
+    "r4k2/pb2bp1r/1p1qp2p/3pNp2/3P1P2/2N3P1/PPP1Q2P/2KRR3 w - - 0 1",
+    "3rr1k1/pp3pp1/1qn2np1/8/3p4/PP1R1P2/2P1NQPP/R1B3K1 b - - 0 1",
+    "2r1nrk1/p2q1ppp/bp1p4/n1pPp3/P1P1P3/2PBB1N1/4QPPP/R4RK1 w - - 0 1",
+    "r3r1k1/ppqb1ppp/8/4p1NQ/8/2P5/PP3PPP/R3R1K1 b - - 0 1",
+
+    // endgames
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "2r3k1/pp3ppp/4p3/3pP3/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "8/5pk1/6p1/7p/P6P/6P1/5PK1/8 w - - 0 1",
+    "6k1/5pp1/7p/8/8/7P/r4PP1/1R4K1 w - - 0 1",
+    "8/8/1k6/8/2R5/8/4K3/r7 w - - 0 1",
+    "8/3b4/5k2/2p5/2P1B3/4K3/8/8 w - - 0 1",
+    "4k3/8/8/8/8/8/4P3/4K3 w - - 0 1",
+    "8/4kp2/6p1/3N4/4P3/5K2/8/3b4 w - - 0 1",
+    "6k1/8/6K1/6P1/8/8/8/7q b - - 0 1",
+};
+
+#define BENCH_FEN_CNT (sizeof(bench_fens)/sizeof(*bench_fens))
+
+static const int bench_threads[] = {1, 2, 4, 8, 16};
+
+#define BENCH_THREADS_CNT (sizeof(bench_threads)/sizeof(*bench_threads))
+
+/**
+ * Get the current wall clock time in milliseconds.
+ */
+static long long bench_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Print a line of the report starting with the given prefix.
+ */
+static void bench_println(const char *prefix, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    printf("%s", prefix);
+    vprintf(format, args);
+    printf("\n");
+
+    va_end(args);
+}
+
+void bench_run(int depth, const char *prefix) {
+    assert(depth >= 1 && depth <= SEARCH_DEPTH_MAX);
+    assert(prefix != NULL);
+
+    struct search_options options = {
+        .algorithm = SEARCH_ALGORITHM_PVS,
+        .depth = depth,
+        .time_limit = 0,
+        .threads = 1,
+        .multi_pv = 1,
+        .post = false,
+        .excluded_cnt = 0,
+    };
+
+    long long time = 0;
+    unsigned long long nodes = 0;
+    unsigned long long ec_hits = 0, ec_misses = 0;
+
+    bench_println(prefix, "%8s %12s %10s %6s", "position", "nodes", "time (ms)", "move");
+
+    for (size_t i = 0; i < BENCH_FEN_CNT; ++i) {
+        struct board board;
+        board_set_fen(&board, bench_fens[i]);
+
+        // every search starts from the same, empty tables
+        tt_clear();
+        ec_clear();
+
+        struct search_stats stats;
+
+        long long start = bench_time();
+        struct move move = search_best_move(&board, &options, &stats);
+        long long elapsed = bench_time() - start;
+
+        time += elapsed;
+        nodes += stats.nodes;
+
+        unsigned long long hits, misses;
+        ec_get_stats(&hits, &misses);
+
+        ec_hits += hits;
+        ec_misses += misses;
+
+        bench_println(prefix, "%8zu %12llu %10lld %4s%s", i + 1, stats.nodes, elapsed,
+                      square_to_str(move.from), square_to_str(move.to));
+    }
+
+    bench_println(prefix, "");
+    bench_println(prefix, "total time (ms) : %lld", time);
+    bench_println(prefix, "nodes searched  : %llu", nodes);
+    bench_println(prefix, "nodes/second    : %llu", nodes * 1000 / (unsigned long long)(time > 0 ? time : 1));
+    bench_println(prefix, "eval cache hits : %.1f%%", 100.0 * ec_hits / (ec_hits + ec_misses > 0 ? ec_hits + ec_misses : 1));
+}
+
+void bench_smp(int depth) {
+    assert(depth >= 1 && depth <= SEARCH_DEPTH_MAX);
+
+    struct search_options options = {
+        .algorithm = SEARCH_ALGORITHM_PVS,
+        .depth = depth,
+        .time_limit = 0,
+        .multi_pv = 1,
+        .post = false,
+        .excluded_cnt = 0,
+    };
+
+    long long base_time = 0;
+    unsigned long long base_nodes = 0;
+
+    printf("%7s %10s %12s %10s %8s %9s\n", "threads", "time (ms)", "nodes", "nps", "speedup", "overhead");
+
+    for (size_t t = 0; t < BENCH_THREADS_CNT; ++t) {
+        options.threads = bench_threads[t];
+
+        long long time = 0;
+        unsigned long long nodes = 0;
+
+        for (size_t i = 0; i < BENCH_FEN_CNT; ++i) {
+            struct board board;
+            board_set_fen(&board, bench_fens[i]);
+
+            // every search starts from the same, empty tables
+            tt_clear();
+            ec_clear();
+
+            struct search_stats stats;
+
+            long long start = bench_time();
+            search_best_move(&board, &options, &stats);
+            time += bench_time() - start;
+
+            nodes += stats.nodes;
+        }
+
+        if (t == 0) {
+            base_time = time > 0 ? time : 1;
+            base_nodes = nodes > 0 ? nodes : 1;
+        }
+
+        printf("%7d %10lld %12llu %10llu %8.2f %8.1f%%\n", options.threads, time, nodes,
+               nodes * 1000 / (unsigned long long)(time > 0 ? time : 1),
+               (double)base_time / (time > 0 ? time : 1),
+               100.0 * ((double)nodes / base_nodes - 1));
+    }
+}
@@ -485,7 +485,10 @@ static void bb_init_king_attacks(void) {
 static bb_t bb_pawn_attacks[COLOR_CNT][SQ_CNT];
 
 static void bb_init_pawn_attacks(void) {
-    for (enum square s = SQ_A2; s <= SQ_H7; ++s) {
+    // squares on the first and last ranks are included, since the attacks
+    // of a pawn of one color placed there are used to find the pawns
+    // of the other color attacking them (see `board_get_attackers`)
+    for (enum square s = 0; s < SQ_CNT; ++s) {
         bb_t bb = bb_squares[s];
 
         bb_pawn_attacks[WHITE][s] = (bb << (FL_CNT-1) & ~bb_files[FL_H])
@@ -5,6 +5,7 @@
 #include "move.h"
 #include "pst.h"
 #include "xboard.h"
+#include "zobrist.h"
 
 #include <assert.h>
 #include <errno.h>
@@ -24,7 +25,28 @@ static void board_clear(struct board *board) {
             board->bb_pieces[c][i] = BB_EMPTY;
         }
 
-        board->pst_scores[c] = 0;
+        board->pst_scores[c] = SCORE_ZERO;
+
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            board->piece_cnts[c][p] = 0;
+        }
+    }
+
+    board->key = ZB_KEY_EMPTY;
+    board->pawn_key = ZB_KEY_EMPTY;
+    board->material_key = ZB_KEY_EMPTY;
+
+    board->prev_key = ZB_KEY_EMPTY;
+    board->change_cnt = 0;
+}
+
+/**
+ * Record a piece change made by the current move (changes made while
+ * setting up a position are not needed, since it has no previous key).
+ */
+static void board_record_change(struct board *board, enum color c, enum piece p, enum square from, enum square to) {
+    if (board->change_cnt < BOARD_CHANGES_MAX) {
+        board->changes[board->change_cnt++] = (struct board_change){ .color = c, .piece = p, .from = from, .to = to };
     }
 }
 
@@ -43,6 +65,15 @@ static void board_add_piece(struct board *board, enum color c, enum piece p, enu
     board->bb_pieces[c][BB_ALL] |= bb_squares[s];
 
     board->pst_scores[c] += pst_values[c][p][s];
+
+    board->key ^= zb_pieces[c][p][s];
+    board->material_key ^= zb_pieces[c][p][board->piece_cnts[c][p]++];
+
+    board_record_change(board, c, p, SQ_NONE, s);
+
+    if (p == PAWN) {
+        board->pawn_key ^= zb_pieces[c][p][s];
+    }
 }
 
 /**
@@ -62,6 +93,15 @@ static void board_remove_piece(struct board *board, enum color c, enum piece p,
     board->bb_pieces[c][BB_ALL] ^= bb_squares[s];
 
     board->pst_scores[c] -= pst_values[c][p][s];
+
+    board->key ^= zb_pieces[c][p][s];
+    board->material_key ^= zb_pieces[c][p][--board->piece_cnts[c][p]];
+
+    board_record_change(board, c, p, s, SQ_NONE);
+
+    if (p == PAWN) {
+        board->pawn_key ^= zb_pieces[c][p][s];
+    }
 }
 
 /**
@@ -86,6 +126,14 @@ static void board_move_piece(struct board *board,
     board->bb_pieces[c][BB_ALL] ^= bb_mask;
 
     board->pst_scores[c] += pst_values[c][p][to]-pst_values[c][p][from];
+
+    board->key ^= zb_pieces[c][p][from] ^ zb_pieces[c][p][to];
+
+    board_record_change(board, c, p, from, to);
+
+    if (p == PAWN) {
+        board->pawn_key ^= zb_pieces[c][p][from] ^ zb_pieces[c][p][to];
+    }
 }
 
 void board_reset(struct board *board) {
@@ -111,6 +159,26 @@ void board_reset(struct board *board) {
 
     board->halfmove_clock = 0;
     board->fullmove_number = 1;
+
+    board->key = zb_get_key(board);
+    board->pawn_key = zb_get_pawn_key(board);
+    board->material_key = zb_get_material_key(board);
+}
+
+void board_update_pst(struct board *board) {
+    assert(board != NULL);
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        board->pst_scores[c] = SCORE_ZERO;
+
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            bb_t bb = board->bb_pieces[c][p];
+
+            while (bb) {
+                board->pst_scores[c] += pst_values[c][p][bb_pop_lsb(&bb)];
+            }
+        }
+    }
 }
 
 void board_set_fen(struct board *board, const char *fen) {
@@ -187,6 +255,10 @@ void board_set_fen(struct board *board, const char *fen) {
     board->halfmove_clock = halfmove_clock;
     board->fullmove_number = fullmove_number;
 
+    board->key = zb_get_key(board);
+    board->pawn_key = zb_get_pawn_key(board);
+    board->material_key = zb_get_material_key(board);
+
     board_print_fancy(board);
 }
 
@@ -195,21 +267,40 @@ bool board_square_under_attack(struct board *board, enum color c, enum square s)
     assert(c >= 0 && c < COLOR_CNT);
     assert(s >= 0 && s < SQ_CNT);
 
-    for (enum piece p = 0; p < PIECE_CNT; ++p) {
-        bb_t bb_pieces = board->bb_pieces[color_flip(c)][p];
+    enum color color_other = color_flip(c);
 
-        while (bb_pieces) {
-            enum square from = bb_pop_lsb(&bb_pieces);
+    // a piece does not attack the square it stands on
+    // (nor any square occupied by its own color)
+    if (board->bb_pieces[color_other][BB_ALL] & bb_squares[s]) {
+        return false;
+    }
 
-            bb_t bb_attacks = board_get_attacks(board, color_flip(c), p, from);
+    bb_t bb_occ = board->bb_pieces[c][BB_ALL] | board->bb_pieces[color_other][BB_ALL];
 
-            if (bb_squares[s] & bb_attacks) {
-                return true;
-            }
-        }
-    }
+    return board_get_attackers(board, s, bb_occ) & board->bb_pieces[color_other][BB_ALL];
+}
+
+bb_t board_get_attackers(struct board *board, enum square s, bb_t bb_occ) {
+    assert(board != NULL);
+    assert(s >= 0 && s < SQ_CNT);
+
+    bb_t (*bb_pieces)[BB_PIECES_SZ] = board->bb_pieces;
+
+    bb_t bb_rooks = bb_pieces[WHITE][BB_ROOKS] | bb_pieces[BLACK][BB_ROOKS]
+                  | bb_pieces[WHITE][BB_QUEENS] | bb_pieces[BLACK][BB_QUEENS];
+
+    bb_t bb_bishops = bb_pieces[WHITE][BB_BISHOPS] | bb_pieces[BLACK][BB_BISHOPS]
+                    | bb_pieces[WHITE][BB_QUEENS] | bb_pieces[BLACK][BB_QUEENS];
 
-    return false;
+    // attacks are symmetric, so the pieces attacking the square are
+    // those that would be attacked by the same piece type placed on it
+    // (except for pawns, which attack in the direction of their color)
+    return (bb_get_attacks(BLACK, PAWN, s, BB_EMPTY) & bb_pieces[WHITE][BB_PAWNS])
+         | (bb_get_attacks(WHITE, PAWN, s, BB_EMPTY) & bb_pieces[BLACK][BB_PAWNS])
+         | (bb_get_attacks(WHITE, KNIGHT, s, BB_EMPTY) & (bb_pieces[WHITE][BB_KNIGHTS] | bb_pieces[BLACK][BB_KNIGHTS]))
+         | (bb_get_attacks(WHITE, KING, s, BB_EMPTY) & (bb_pieces[WHITE][BB_KING] | bb_pieces[BLACK][BB_KING]))
+         | (bb_get_attacks(WHITE, ROOK, s, bb_occ) & bb_rooks)
+         | (bb_get_attacks(WHITE, BISHOP, s, bb_occ) & bb_bishops);
 }
 
 bool board_color_in_check(struct board *board, enum color c) {
@@ -282,9 +373,10 @@ bool board_color_castle_queen(struct board *board, enum color c) {
         return false;
     }
 
+    // the rook passes next to the king, but the king
+    // does not, so that square may be attacked
     if (board_square_under_attack(board, c, ks-1) ||
-        board_square_under_attack(board, c, ks-2) ||
-        board_square_under_attack(board, c, ks-3))
+        board_square_under_attack(board, c, ks-2))
     {
         return false;
     }
@@ -292,12 +384,83 @@ bool board_color_castle_queen(struct board *board, enum color c) {
     return true;
 }
 
-bb_t board_get_attacks(struct board *board, enum color c, enum piece p, enum square s) {
-    bb_t bb_occ = p == ROOK || p == BISHOP || p == QUEEN
-                ? board->bb_pieces[c][BB_ALL] | board->bb_pieces[color_flip(c)][BB_ALL]
-                : BB_EMPTY;
+/**
+ * Compute the attack maps of a board.
+ */
+static void board_compute_attack_maps(struct board *board, struct board_attacks *attacks) {
+    enum color color = board->color;
+    enum color color_other = color_flip(color);
+
+    bb_t bb_occ = board->bb_pieces[WHITE][BB_ALL] | board->bb_pieces[BLACK][BB_ALL];
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        attacks->by_color[c] = BB_EMPTY;
+        attacks->double_attacks[c] = BB_EMPTY;
+
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            attacks->by_piece[c][p] = BB_EMPTY;
+
+            bb_t bb_pieces = board->bb_pieces[c][p];
+
+            while (bb_pieces) {
+                enum square s = bb_pop_lsb(&bb_pieces);
+
+                bb_t bb_attacks = bb_get_attacks(c, p, s, bb_occ);
+
+                attacks->by_square[s] = bb_attacks;
+                attacks->by_piece[c][p] |= bb_attacks;
+
+                attacks->double_attacks[c] |= attacks->by_color[c] & bb_attacks;
+                attacks->by_color[c] |= bb_attacks;
+            }
+        }
+    }
+
+    attacks->checkers = BB_EMPTY;
+    attacks->pinned = BB_EMPTY;
+
+    enum square ks = bb_scan_lsb(board->bb_pieces[color][BB_KING]);
+
+    if (ks != SQ_NONE) {
+        attacks->checkers = board_get_attackers(board, ks, bb_occ) & board->bb_pieces[color_other][BB_ALL];
+
+        // sliding pieces that would attack the king if it were alone on the board
+        // pin the piece of the side to move standing alone between them and the king
+        bb_t bb_rooks = board->bb_pieces[color_other][BB_ROOKS] | board->bb_pieces[color_other][BB_QUEENS];
+        bb_t bb_bishops = board->bb_pieces[color_other][BB_BISHOPS] | board->bb_pieces[color_other][BB_QUEENS];
+
+        bb_t bb_snipers = (bb_get_attacks(color, ROOK, ks, BB_EMPTY) & bb_rooks)
+                        | (bb_get_attacks(color, BISHOP, ks, BB_EMPTY) & bb_bishops);
+
+        while (bb_snipers) {
+            enum square s = bb_pop_lsb(&bb_snipers);
 
-    return bb_get_attacks(c, p, s, bb_occ) & ~board->bb_pieces[c][BB_ALL];
+            enum piece p = bb_rooks & bb_get_attacks(color, ROOK, ks, BB_EMPTY) & bb_squares[s] ? ROOK : BISHOP;
+
+            bb_t bb_between = bb_get_attacks(color, p, ks, bb_squares[s]) & bb_get_attacks(color, p, s, bb_squares[ks]);
+            bb_t bb_blockers = bb_between & bb_occ;
+
+            if (bb_blockers && !(bb_blockers & (bb_blockers-1))) {
+                attacks->pinned |= bb_blockers & board->bb_pieces[color][BB_ALL];
+            }
+        }
+    }
+
+    attacks->key = board->key;
+}
+
+const struct board_attacks * board_get_attack_maps(struct board *board) {
+    assert(board != NULL);
+
+    static __thread struct board_attacks attack_maps[BOARD_ATTACKS_CNT];
+
+    struct board_attacks *attacks = &attack_maps[board->key & (BOARD_ATTACKS_CNT-1)];
+
+    if (attacks->key != board->key || attacks->key == ZB_KEY_EMPTY) {
+        board_compute_attack_maps(board, attacks);
+    }
+
+    return attacks;
 }
 
 void board_do_move(struct board *board, struct move move) {
@@ -306,6 +469,17 @@ void board_do_move(struct board *board, struct move move) {
     enum color color = board->color;
     enum color color_other = color_flip(color);
 
+    board->prev_key = board->key;
+    board->change_cnt = 0;
+
+    // castle rights and en passant target are hashed back in
+    // after they are updated below
+    board->key ^= zb_castle_rights[board->castle_rights];
+
+    if (board->en_passant != SQ_NONE) {
+        board->key ^= zb_en_passant[square_to_file(board->en_passant)];
+    }
+
     if (move.flags & MOVE_FLAG_CAPTURE) {
         board_remove_piece(board, color_other, move.capture, move.to);
 
@@ -358,6 +532,18 @@ void board_do_move(struct board *board, struct move move) {
     }
 
     board->color = color_other;
+
+    board->key ^= zb_castle_rights[board->castle_rights];
+
+    if (board->en_passant != SQ_NONE) {
+        board->key ^= zb_en_passant[square_to_file(board->en_passant)];
+    }
+
+    board->key ^= zb_color;
+
+    assert(board->key == zb_get_key(board));
+    assert(board->pawn_key == zb_get_pawn_key(board));
+    assert(board->material_key == zb_get_material_key(board));
 }
 
 void board_print(struct board *board) {
@@ -411,7 +597,7 @@ void board_print(struct board *board) {
     xb_comment("\n");
 
     for (enum color c = 0; c < COLOR_CNT; ++c) {
-        xb_comment("%d ", board->pst_scores[c]);
+        xb_comment("%d/%d ", score_mg(board->pst_scores[c]), score_eg(board->pst_scores[c]));
     }
 
     xb_comment("\n");
@@ -476,7 +662,7 @@ void board_print_fancy(struct board *board) {
     xb_comment("+---+------+----+-------+-------+\n");
 
     for (enum color c = 0; c < COLOR_CNT; ++c) {
-        xb_comment("| %-13d ", board->pst_scores[c]);
+        xb_comment("| %-6d %-6d ", score_mg(board->pst_scores[c]), score_eg(board->pst_scores[c]));
     }
 
     xb_comment("|\n");
@@ -0,0 +1,402 @@
+#include "dfpn.h"
+
+#include "board.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+#include "zobrist.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Proof-number search:
+ * https://www.chessprogramming.org/Proof-Number_Search
+ *
+ * Depth-first proof-number search (df-pn):
+ * https://www.chessprogramming.org/Proof-Number_Search#Depth-First_Proof-Number_Search
+ * Ayumu Nagai, "Df-pn Algorithm for Searching AND/OR Trees and Its Applications" (2002)
+ *
+ */
+
+/**
+ * Proof or disproof number of a solved node (infinite work).
+ */
+#define DFPN_INF (UINT32_MAX / 2)
+
+/**
+ * Structure representing the numbers of a node of the searched tree.
+ * Nodes are stored in negamax form: `phi` is the work left to prove that the
+ * side to move reaches its goal (mating for the attacker, escaping for the
+ * defender) and `delta` the work left to disprove it.
+ */
+struct dfpn_entry {
+    zb_key_t key;
+
+    uint32_t phi;
+    uint32_t delta;
+
+    uint32_t work; // number of nodes visited to compute the numbers (replacement priority)
+
+    uint8_t depth; // number of plies left to the attacker for mating
+    uint8_t dist; // number of plies to the end of the game once solved
+};
+
+static struct dfpn_entry *dfpn_table = NULL;
+
+static enum color dfpn_attacker = WHITE;
+static unsigned long long dfpn_nodes = 0;
+static int dfpn_mate_len = 0; // number of moves of the attacker in the mate proven by the last solve
+
+/**
+ * Look up the numbers of a position with `depth` plies left, from the point
+ * of view of its side to move (the attacker if `attacker`). Positions not in
+ * the table get unit numbers. Proven mates also hold with more plies left
+ * and disproven ones with fewer, other numbers only with the same plies.
+ */
+static struct dfpn_entry dfpn_lookup(zb_key_t key, int depth, bool attacker) {
+    struct dfpn_entry *bucket = &dfpn_table[(key & (DFPN_TABLE_CNT-1)) * DFPN_TABLE_WAYS];
+
+    for (size_t i = 0; i < DFPN_TABLE_WAYS; ++i) {
+        struct dfpn_entry *entry = &bucket[i];
+
+        if (entry->key != key || entry->work == 0) {
+            continue;
+        }
+
+        bool mate = attacker ? entry->phi == 0 : entry->delta == 0;
+        bool no_mate = attacker ? entry->delta == 0 : entry->phi == 0;
+
+        if (entry->depth == depth || (mate && entry->depth < depth) || (no_mate && entry->depth > depth)) {
+            return *entry;
+        }
+    }
+
+    return (struct dfpn_entry){ .key = key, .phi = 1, .delta = 1, .depth = depth };
+}
+
+/**
+ * Store the numbers of a position, replacing the entry of the bucket
+ * with the same plies left or else the one that took the least work.
+ */
+static void dfpn_store(const struct dfpn_entry *entry) {
+    struct dfpn_entry *bucket = &dfpn_table[(entry->key & (DFPN_TABLE_CNT-1)) * DFPN_TABLE_WAYS];
+
+    struct dfpn_entry *replaced = &bucket[0];
+
+    for (size_t i = 0; i < DFPN_TABLE_WAYS; ++i) {
+        if (bucket[i].key == entry->key && bucket[i].depth == entry->depth) {
+            replaced = &bucket[i];
+            break;
+        }
+
+        if (bucket[i].work < replaced->work) {
+            replaced = &bucket[i];
+        }
+    }
+
+    *replaced = *entry;
+}
+
+/**
+ * Expand a node until its proof number reaches `phi_th` or its disproof number
+ * reaches `delta_th` (multiple iterative deepening), always descending into the
+ * child with the smallest disproof number, i.e. into the most proving node.
+ * The root node is given its (filtered) moves, the other ones generate them.
+ * Returns the numbers of the node, which are also stored in the table.
+ */
+static struct dfpn_entry dfpn_mid(struct board *board, const struct move_list *root_moves, int depth,
+                                  uint32_t phi_th, uint32_t delta_th)
+{
+    bool attacker = board->color == dfpn_attacker;
+
+    unsigned long long nodes_start = dfpn_nodes++;
+    search_check_limits();
+
+    struct dfpn_entry entry = { .key = board->key, .depth = depth };
+
+    struct move_list moves;
+
+    if (root_moves != NULL) {
+        moves = *root_moves;
+    } else {
+        movegen_add_moves(&moves, board);
+    }
+
+    // a side that cannot move is mated or stalemated (the attacker fails either
+    // way) and the defender escapes once the attacker has no plies left
+    if (moves.count == 0 || depth == 0) {
+        if (attacker || (moves.count == 0 && board_color_in_check(board, board->color))) {
+            entry.phi = DFPN_INF;
+            entry.delta = 0;
+        } else {
+            entry.phi = 0;
+            entry.delta = DFPN_INF;
+        }
+
+        entry.work = 1;
+        dfpn_store(&entry);
+
+        return entry;
+    }
+
+    // numbers of the children from their side to move's point of view
+    uint32_t phis[MOVE_LIST_MAX];
+    uint32_t deltas[MOVE_LIST_MAX];
+    uint8_t dists[MOVE_LIST_MAX];
+
+    for (size_t i = 0; i < moves.count; ++i) {
+        struct board board_copy = *board;
+        board_do_move(&board_copy, moves.list[i]);
+
+        struct dfpn_entry child = dfpn_lookup(board_copy.key, depth - 1, !attacker);
+
+        phis[i] = child.phi;
+        deltas[i] = child.delta;
+        dists[i] = child.dist;
+    }
+
+    while (true) {
+        // the node is proven by any child disproven and
+        // disproven only by all of its children proven
+        uint32_t phi = DFPN_INF;
+        uint64_t delta = 0;
+
+        size_t best = 0;
+        uint32_t second_phi = DFPN_INF; // smallest proof number of the node without the best child
+
+        for (size_t i = 0; i < moves.count; ++i) {
+            delta += phis[i];
+
+            if (deltas[i] < phi) {
+                second_phi = phi;
+                phi = deltas[i];
+                best = i;
+            } else if (deltas[i] < second_phi) {
+                second_phi = deltas[i];
+            }
+        }
+
+        entry.phi = phi;
+        entry.delta = delta < DFPN_INF ? delta : DFPN_INF;
+
+        if (entry.phi >= phi_th || entry.delta >= delta_th || search_stopped()) {
+            break;
+        }
+
+        // the child is searched until it is no longer the most proving one
+        // or until the node disproof number would exceed its threshold
+        uint32_t child_phi_th = delta_th - entry.delta + phis[best];
+        uint32_t child_delta_th = second_phi < phi_th ? second_phi + 1 : phi_th;
+
+        struct board board_copy = *board;
+        board_do_move(&board_copy, moves.list[best]);
+
+        struct dfpn_entry child = dfpn_mid(&board_copy, NULL, depth - 1, child_phi_th, child_delta_th);
+
+        phis[best] = child.phi;
+        deltas[best] = child.delta;
+        dists[best] = child.dist;
+    }
+
+    // a proven node ends the game through its shortest proven child,
+    // a disproven one through its longest child
+    entry.dist = 0;
+
+    for (size_t i = 0; i < moves.count; ++i) {
+        if (entry.phi == 0 && deltas[i] == 0 && (entry.dist == 0 || dists[i] + 1 < entry.dist)) {
+            entry.dist = dists[i] + 1;
+        }
+
+        if (entry.delta == 0 && dists[i] + 1 > entry.dist) {
+            entry.dist = dists[i] + 1;
+        }
+    }
+
+    entry.work = dfpn_nodes - nodes_start < UINT32_MAX ? dfpn_nodes - nodes_start : UINT32_MAX;
+    dfpn_store(&entry);
+
+    return entry;
+}
+
+void dfpn_term(void) {
+    free(dfpn_table);
+    dfpn_table = NULL;
+}
+
+size_t dfpn_solve(struct board *board, const struct move_list *moves, int mate_max,
+                  struct move pv[SEARCH_PV_LEN_MAX])
+{
+    assert(board != NULL);
+    assert(moves != NULL);
+    assert(mate_max >= 1 && mate_max <= DFPN_MATE_MAX);
+
+    if (dfpn_table == NULL) {
+        dfpn_table = malloc(DFPN_TABLE_CNT*DFPN_TABLE_WAYS*sizeof(*dfpn_table));
+
+        if (dfpn_table == NULL) {
+            error(EXIT_FAILURE, errno, "could not allocate space for proof number table");
+        }
+    }
+
+    // the root moves and the attacker change between solves
+    memset(dfpn_table, 0, DFPN_TABLE_CNT*DFPN_TABLE_WAYS*sizeof(*dfpn_table));
+
+    dfpn_attacker = board->color;
+    dfpn_nodes = 0;
+    dfpn_mate_len = 0;
+
+    int depth = 2*mate_max - 1;
+
+    struct dfpn_entry root = dfpn_mid(board, moves, depth, DFPN_INF, DFPN_INF);
+
+    if (root.phi != 0) {
+        return 0;
+    }
+
+    // follow the proof: the attacker plays its shortest mate
+    // and the defender its longest defense
+    struct board board_copy = *board;
+
+    size_t len = 0;
+
+    // longest mate proven against the other defenses at each defender node
+    int other_dists[SEARCH_PV_LEN_MAX];
+
+    while (len < SEARCH_PV_LEN_MAX && depth > 0) {
+        bool attacker = board_copy.color == dfpn_attacker;
+
+        struct move_list children;
+
+        if (len == 0) {
+            children = *moves;
+        } else {
+            movegen_add_moves(&children, &board_copy);
+        }
+
+        struct move best = { .flags = MOVE_FLAG_INVALID };
+        int best_dist = attacker ? INT_MAX : -1;
+        int other_dist = -1;
+
+        // children evicted from the table are solved again: all of those of
+        // the defender, those of the attacker only if none is known to mate
+        for (int pass = attacker ? 0 : 1; pass < 2 && best.flags == MOVE_FLAG_INVALID; ++pass) {
+            for (size_t i = 0; i < children.count; ++i) {
+                struct board child_board = board_copy;
+                board_do_move(&child_board, children.list[i]);
+
+                struct dfpn_entry child = dfpn_lookup(child_board.key, depth - 1, !attacker);
+
+                if (pass == 1 && child.phi != 0 && child.delta != 0) {
+                    child = dfpn_mid(&child_board, NULL, depth - 1, DFPN_INF, DFPN_INF);
+                }
+
+                // children in which the attacker still mates (proven for the
+                // attacker, disproven from the point of view of the defender)
+                bool mating = attacker ? child.delta == 0 : child.phi == 0;
+
+                // a defense that is not refuted (the solve stopped) leaves no proof
+                if (!attacker && !mating) {
+                    return 0;
+                }
+
+                if (mating && (attacker ? child.dist < best_dist : child.dist > best_dist)) {
+                    other_dist = best_dist;
+                    best = children.list[i];
+                    best_dist = child.dist;
+                } else if (!attacker && child.dist > other_dist) {
+                    other_dist = child.dist;
+                }
+
+                // any mating move found again will do for the attacker
+                if (attacker && pass == 1 && mating) {
+                    break;
+                }
+            }
+        }
+
+        // the line ends once the defender has no move left
+        if (best.flags == MOVE_FLAG_INVALID) {
+            break;
+        }
+
+        other_dists[len] = attacker ? -1 : other_dist;
+        pv[len++] = best;
+        board_do_move(&board_copy, best);
+
+        // the rest of the line is searched within the plies the proof of
+        // the move needs, so that it never gets longer than that proof
+        depth = best_dist;
+    }
+
+    // only a line ending in mate is returned
+    struct move_list replies;
+    movegen_add_moves(&replies, &board_copy);
+
+    if (len == 0 || board_copy.color == dfpn_attacker || replies.count > 0 ||
+        !board_color_in_check(&board_copy, board_copy.color))
+    {
+        return 0;
+    }
+
+    // the length of the mate is bounded back from the end of the line by the
+    // mates proven against the other defenses (the entries of the root and of
+    // the first moves only hold the first mates proven, often longer ones)
+    int dist = 0;
+
+    for (size_t i = len; i-- > 0; ) {
+        dist = 1 + (other_dists[i] > dist ? other_dists[i] : dist);
+    }
+
+    dfpn_mate_len = (dist + 1) / 2;
+
+    return len;
+}
+
+unsigned long long dfpn_get_nodes(void) {
+    return dfpn_nodes;
+}
+
+int dfpn_get_mate_len(void) {
+    return dfpn_mate_len;
+}
+
+void dfpn_mate(const char *fen, int mate_max) {
+    assert(fen != NULL);
+
+    struct board board;
+    board_set_fen(&board, fen);
+
+    struct move_list moves;
+    movegen_add_moves(&moves, &board);
+
+    struct move pv[SEARCH_PV_LEN_MAX];
+    size_t len = dfpn_solve(&board, &moves, mate_max, pv);
+
+    if (len == 0) {
+        printf("no mate in %d (%llu nodes)\n", mate_max, dfpn_nodes);
+        return;
+    }
+
+    printf("mate in %d (%llu nodes):", dfpn_mate_len, dfpn_nodes);
+
+    for (size_t i = 0; i < len; ++i) {
+        printf(" %s%s", square_to_str(pv[i].from), square_to_str(pv[i].to));
+
+        if (pv[i].flags & MOVE_FLAG_PROMOTION) {
+            printf("%c", piece_to_char(BLACK, pv[i].promotion));
+        }
+    }
+
+    printf("\n");
+}
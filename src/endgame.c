@@ -0,0 +1,502 @@
+#include "endgame.h"
+
+#include "bitboard.h"
+#include "eval.h"
+#include "evalparams.h"
+#include "zobrist.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Endgame evaluation and scaling:
+ * https://www.chessprogramming.org/Endgame
+ * https://www.chessprogramming.org/Material_Hash_Table
+ *
+ * KPK bitbase:
+ * https://www.chessprogramming.org/KPK
+ *
+ */
+
+/**
+ * Specialized endgame of an exact material signature,
+ * registered for both colors as the stronger side.
+ */
+struct eg_entry {
+    zb_key_t key; // material key of the signature
+    enum color strong;
+    eg_eval_fn *eval;
+};
+
+/**
+ * Maximum number of registered endgames (both colors counted).
+ */
+#define EG_ENTRIES_MAX 16
+
+static struct eg_entry eg_entries[EG_ENTRIES_MAX];
+static size_t eg_entries_cnt = 0;
+
+/**
+ * Number of positions of the KPK bitbase: side to move, square of each king
+ * and square of the pawn, which is mirrored onto files A to D and can only
+ * stand on ranks 2 to 7.
+ */
+#define KPK_INDEX_CNT (COLOR_CNT * SQ_CNT * SQ_CNT * (FL_CNT/2) * (RK_CNT-2))
+
+/**
+ * Wins of the KPK bitbase (one bit per position, WHITE having the pawn).
+ */
+static uint64_t kpk_wins[KPK_INDEX_CNT / 64];
+
+/**
+ * Results of the positions of the KPK bitbase during its classification
+ * (one of them, or a set of them while merging the results of the moves).
+ */
+enum kpk_result {
+    KPK_INVALID = 0,
+    KPK_UNKNOWN = 1 << 0,
+    KPK_DRAW    = 1 << 1,
+    KPK_WIN     = 1 << 2,
+};
+
+/**
+ * Get the index of a position in the KPK bitbase
+ * (the pawn on files A to D and ranks 2 to 7).
+ */
+static size_t kpk_index(enum color color, enum square white_king, enum square black_king, enum square pawn) {
+    assert(square_to_file(pawn) <= FL_D);
+    assert(square_to_rank(pawn) >= RK_2 && square_to_rank(pawn) <= RK_7);
+
+    return (size_t)white_king | (size_t)black_king << 6 | (size_t)color << 12
+         | (size_t)square_to_file(pawn) << 13 | (size_t)(RK_7 - square_to_rank(pawn)) << 15;
+}
+
+/**
+ * Get the result of a position of the KPK bitbase that follows from the rules
+ * alone (`KPK_UNKNOWN` if its moves have to be looked at).
+ */
+static enum kpk_result kpk_classify_rules(size_t idx) {
+    enum square white_king = idx & 63;
+    enum square black_king = idx >> 6 & 63;
+    enum color color = idx >> 12 & 1;
+    enum square pawn = rank_file_to_square(RK_7 - (idx >> 15), idx >> 13 & 3);
+
+    bb_t white_king_attacks = bb_get_attacks(WHITE, KING, white_king, BB_EMPTY);
+    bb_t black_king_attacks = bb_get_attacks(BLACK, KING, black_king, BB_EMPTY);
+    bb_t pawn_attacks = bb_pawn_attacks_set(WHITE, bb_squares[pawn]);
+
+    if (square_distance(white_king, black_king) <= 1 || white_king == pawn || black_king == pawn
+     || (color == WHITE && (pawn_attacks & bb_squares[black_king]))) {
+        return KPK_INVALID;
+    }
+
+    // the pawn promotes without being captured
+    enum square stop = pawn + FL_CNT;
+
+    if (color == WHITE && square_to_rank(pawn) == RK_7 && white_king != stop
+     && (square_distance(black_king, stop) > 1 || square_distance(white_king, stop) == 1)) {
+        return KPK_WIN;
+    }
+
+    // stalemate or the pawn is captured
+    if (color == BLACK && (!(black_king_attacks & ~(white_king_attacks | pawn_attacks))
+                        || (black_king_attacks & bb_squares[pawn] & ~white_king_attacks))) {
+        return KPK_DRAW;
+    }
+
+    return KPK_UNKNOWN;
+}
+
+/**
+ * Get the result of a position of the KPK bitbase from the results
+ * of the positions its moves lead to.
+ */
+static enum kpk_result kpk_classify_moves(const uint8_t *results, size_t idx) {
+    enum square white_king = idx & 63;
+    enum square black_king = idx >> 6 & 63;
+    enum color color = idx >> 12 & 1;
+    enum square pawn = rank_file_to_square(RK_7 - (idx >> 15), idx >> 13 & 3);
+
+    // a single good move is enough, otherwise all of them have to be bad
+    enum kpk_result good = color == WHITE ? KPK_WIN : KPK_DRAW;
+    enum kpk_result bad = color == WHITE ? KPK_DRAW : KPK_WIN;
+
+    unsigned r = KPK_INVALID;
+
+    bb_t bb = bb_get_attacks(color, KING, color == WHITE ? white_king : black_king, BB_EMPTY);
+
+    while (bb) {
+        enum square to = bb_pop_lsb(&bb);
+
+        r |= color == WHITE ? results[kpk_index(BLACK, to, black_king, pawn)]
+                            : results[kpk_index(WHITE, white_king, to, pawn)];
+    }
+
+    if (color == WHITE) {
+        enum square stop = pawn + FL_CNT;
+
+        // positions with the pawn blocked by a king are invalid
+        if (square_to_rank(pawn) < RK_7) {
+            r |= results[kpk_index(BLACK, white_king, black_king, stop)];
+        }
+
+        if (square_to_rank(pawn) == RK_2 && stop != white_king && stop != black_king) {
+            r |= results[kpk_index(BLACK, white_king, black_king, stop + FL_CNT)];
+        }
+    }
+
+    return r & good ? good : r & KPK_UNKNOWN ? KPK_UNKNOWN : bad;
+}
+
+/**
+ * Build the KPK bitbase by retrograde classification: starting from the
+ * positions whose results follow from the rules, the other ones are
+ * classified from their moves until no result changes anymore.
+ */
+static void kpk_init(void) {
+    uint8_t *results = malloc(KPK_INDEX_CNT);
+
+    if (results == NULL) {
+        error(EXIT_FAILURE, errno, "could not allocate space for KPK bitbase");
+    }
+
+    for (size_t idx = 0; idx < KPK_INDEX_CNT; ++idx) {
+        results[idx] = kpk_classify_rules(idx);
+    }
+
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (size_t idx = 0; idx < KPK_INDEX_CNT; ++idx) {
+            if (results[idx] == KPK_UNKNOWN) {
+                results[idx] = kpk_classify_moves(results, idx);
+                changed |= results[idx] != KPK_UNKNOWN;
+            }
+        }
+    }
+
+    // the positions still unknown cannot be won
+    for (size_t idx = 0; idx < KPK_INDEX_CNT; ++idx) {
+        if (results[idx] == KPK_WIN) {
+            kpk_wins[idx / 64] |= (uint64_t)1 << (idx % 64);
+        }
+    }
+
+    free(results);
+}
+
+/**
+ * Check if the given KPK position is won by the side with the pawn.
+ */
+static bool kpk_probe(enum color strong, enum square strong_king, enum square weak_king, enum square pawn, enum color color) {
+    // the bitbase has WHITE with the pawn on files A to D
+    if (strong == BLACK) {
+        strong_king ^= 56;
+        weak_king ^= 56;
+        pawn ^= 56;
+    }
+
+    if (square_to_file(pawn) > FL_D) {
+        strong_king ^= 7;
+        weak_king ^= 7;
+        pawn ^= 7;
+    }
+
+    size_t idx = kpk_index(color == strong ? WHITE : BLACK, strong_king, weak_king, pawn);
+
+    return kpk_wins[idx / 64] >> (idx % 64) & 1;
+}
+
+/**
+ * Get the square of the only piece of the given type and color.
+ */
+static enum square eg_square(struct board *board, enum color color, enum piece piece) {
+    assert(board->piece_cnts[color][piece] == 1);
+
+    return bb_scan_lsb(board->bb_pieces[color][piece]);
+}
+
+/**
+ * Get the bonus of a king for being close to the edge of the board.
+ */
+static int eg_push_to_edge(enum square sq) {
+    int rank_dist = square_to_rank(sq) < RK_CNT/2 ? square_to_rank(sq) : RK_8 - square_to_rank(sq);
+    int file_dist = square_to_file(sq) < FL_CNT/2 ? square_to_file(sq) : FL_H - square_to_file(sq);
+
+    return 90 - (7*file_dist*file_dist/2 + 7*rank_dist*rank_dist/2);
+}
+
+/**
+ * Get the bonus of a king for being close to one of the corners A1 and H8.
+ */
+static int eg_push_to_corner(enum square sq) {
+    return abs(RK_8 - (int)square_to_rank(sq) - (int)square_to_file(sq));
+}
+
+/**
+ * Get the bonus of two kings for being close to each other.
+ */
+static int eg_push_close(enum square sq1, enum square sq2) {
+    return 140 - 20*square_distance(sq1, sq2);
+}
+
+/**
+ * Lone king against mating material (KRK, KQK and any other): the lone king
+ * is driven to the edge and the other king brought close to it.
+ */
+static int eg_eval_kxk(struct board *board, enum color strong) {
+    enum color weak = color_flip(strong);
+
+    const uint8_t *cnts = board->piece_cnts[strong];
+    const int *values = eval_params.piece_values;
+
+    enum square strong_king = eg_square(board, strong, KING);
+    enum square weak_king = eg_square(board, weak, KING);
+
+    int score = values[PAWN] * cnts[PAWN] + values[KNIGHT] * cnts[KNIGHT] + values[BISHOP] * cnts[BISHOP]
+              + values[ROOK] * cnts[ROOK] + values[QUEEN] * cnts[QUEEN]
+              + eg_push_to_edge(weak_king) + eg_push_close(strong_king, weak_king);
+
+    bb_t bb_bishops = board->bb_pieces[strong][BB_BISHOPS];
+
+    if (cnts[QUEEN] || cnts[ROOK] || (cnts[BISHOP] && cnts[KNIGHT])
+     || ((bb_bishops & black_squares) && (bb_bishops & white_squares))) {
+        score += EG_KNOWN_WIN;
+    }
+
+    return score;
+}
+
+/**
+ * Bishop and knight against king: the lone king is driven
+ * to a corner of the color of the bishop.
+ */
+static int eg_eval_kbnk(struct board *board, enum color strong) {
+    enum square strong_king = eg_square(board, strong, KING);
+    enum square weak_king = eg_square(board, color_flip(strong), KING);
+    enum square bishop = eg_square(board, strong, BISHOP);
+
+    // corners A8 and H1 are reached by the mirrored square of the king
+    // when the bishop is not on the color of A1 and H8
+    enum square corner_king = bb_squares[bishop] & black_squares ? weak_king : weak_king ^ 7;
+
+    return EG_KNOWN_WIN + eg_push_close(strong_king, weak_king) + 420 * eg_push_to_corner(corner_king);
+}
+
+/**
+ * King and pawn against king: known result from the KPK bitbase.
+ */
+static int eg_eval_kpk(struct board *board, enum color strong) {
+    enum square strong_king = eg_square(board, strong, KING);
+    enum square weak_king = eg_square(board, color_flip(strong), KING);
+    enum square pawn = eg_square(board, strong, PAWN);
+
+    if (!kpk_probe(strong, strong_king, weak_king, pawn, board->color)) {
+        return 0;
+    }
+
+    enum rank rank = strong == WHITE ? square_to_rank(pawn) : RK_8 - square_to_rank(pawn);
+
+    return EG_KNOWN_WIN + eval_params.piece_values[PAWN] + rank;
+}
+
+/**
+ * Rook against pawn: won if the stronger king stops the pawn in time,
+ * drawish if the pawn is far advanced and supported by its king.
+ */
+static int eg_eval_krkp(struct board *board, enum color strong) {
+    enum color weak = color_flip(strong);
+
+    // squares as seen from the stronger side (the pawn moves towards rank 1)
+    int flip = strong == WHITE ? 0 : 56;
+
+    enum square strong_king = eg_square(board, strong, KING) ^ flip;
+    enum square weak_king = eg_square(board, weak, KING) ^ flip;
+    enum square rook = eg_square(board, strong, ROOK) ^ flip;
+    enum square pawn = eg_square(board, weak, PAWN) ^ flip;
+
+    enum square queening = rank_file_to_square(RK_1, square_to_file(pawn));
+    enum square stop = pawn - FL_CNT;
+
+    int rook_value = eval_params.piece_values[ROOK];
+
+    // the stronger king stands in front of the pawn,
+    // or the weaker king is too far from the pawn and the rook
+    if ((square_to_file(strong_king) == square_to_file(pawn) && strong_king < pawn)
+     || (square_distance(weak_king, pawn) >= 3 + (board->color == weak) && square_distance(weak_king, rook) >= 3)) {
+        return rook_value - square_distance(strong_king, pawn);
+    }
+
+    // the pawn is far advanced and supported by its king
+    if (square_to_rank(weak_king) <= RK_3 && square_distance(weak_king, pawn) == 1
+     && square_to_rank(strong_king) >= RK_4 && square_distance(strong_king, pawn) > 2 + (board->color == strong)) {
+        return 80 - 8*square_distance(strong_king, pawn);
+    }
+
+    return 200 - 8*(square_distance(strong_king, stop) - square_distance(weak_king, stop)
+                  - square_distance(pawn, queening));
+}
+
+/**
+ * Two knights against king: no mate can be forced.
+ */
+static int eg_eval_knnk(struct board *board, enum color strong) {
+    (void)board;
+    (void)strong;
+
+    return 0;
+}
+
+/**
+ * Opposite-colored bishops without other pieces: the pawns of the side
+ * ahead are rarely enough to win, even less so when there is only one.
+ */
+static int eg_scale_opposite_bishops(struct board *board, enum color strong) {
+    bb_t bb_bishops = board->bb_pieces[strong][BB_BISHOPS] | board->bb_pieces[color_flip(strong)][BB_BISHOPS];
+
+    if (!(bb_bishops & black_squares) || !(bb_bishops & white_squares)) {
+        return EG_SCALE_NONE;
+    }
+
+    int pawns = board->piece_cnts[WHITE][PAWN] + board->piece_cnts[BLACK][PAWN];
+
+    return pawns > 1 ? 31 : 9;
+}
+
+/**
+ * Pawns on a single rook file (with at most a bishop): drawn when the weaker
+ * king stands in front of them, or when it reaches the promotion corner and
+ * the bishop does not control it.
+ */
+static int eg_scale_rook_pawns(struct board *board, enum color strong) {
+    enum color weak = color_flip(strong);
+
+    bb_t bb_pawns = board->bb_pieces[strong][BB_PAWNS];
+
+    if ((bb_pawns & ~bb_files[FL_A]) && (bb_pawns & ~bb_files[FL_H])) {
+        return EG_SCALE_NONE;
+    }
+
+    enum square weak_king = eg_square(board, weak, KING);
+
+    if (board->piece_cnts[strong][BISHOP] == 0) {
+        // the squares in front of the weaker king on its own and adjacent files
+        bb_t bb_front = bb_span_front(weak, board->bb_pieces[weak][BB_KING]);
+        bb_front |= bb_shift_east(bb_front) | bb_shift_west(bb_front);
+
+        return bb_pawns & ~bb_front ? EG_SCALE_NONE : SCALE_DRAW;
+    }
+
+    enum square queening = rank_file_to_square(strong == WHITE ? RK_8 : RK_1, square_to_file(bb_scan_lsb(bb_pawns)));
+    enum square bishop = eg_square(board, strong, BISHOP);
+
+    bool same_color = !(bb_squares[bishop] & black_squares) == !(bb_squares[queening] & black_squares);
+
+    return !same_color && square_distance(queening, weak_king) <= 1 ? SCALE_DRAW : EG_SCALE_NONE;
+}
+
+/**
+ * Register a specialized endgame for both colors from its material
+ * signature (e.g. "KBNK"), the pieces of the stronger side first.
+ */
+static void eg_register(const char *signature, eg_eval_fn *eval) {
+    assert(signature[0] == 'K');
+    assert(eg_entries_cnt + COLOR_CNT <= EG_ENTRIES_MAX);
+
+    for (enum color strong = WHITE; strong < COLOR_CNT; ++strong) {
+        uint8_t cnts[COLOR_CNT][PIECE_CNT] = {{0}};
+
+        zb_key_t key = ZB_KEY_EMPTY;
+
+        // the second king starts the pieces of the weaker side
+        enum color color = color_flip(strong);
+
+        for (const char *c = signature; *c != '\0'; ++c) {
+            enum piece piece = char_to_piece(*c);
+
+            if (piece == KING) {
+                color = color_flip(color);
+            }
+
+            key ^= zb_pieces[color][piece][cnts[color][piece]++];
+        }
+
+        eg_entries[eg_entries_cnt++] = (struct eg_entry){key, strong, eval};
+    }
+}
+
+void eg_init(void) {
+    eg_register("KBNK", eg_eval_kbnk);
+    eg_register("KPK", eg_eval_kpk);
+    eg_register("KRKP", eg_eval_krkp);
+    eg_register("KNNK", eg_eval_knnk);
+
+    kpk_init();
+}
+
+/**
+ * Get the value of the pieces other than pawns of the given color.
+ */
+static int eg_non_pawn_material(struct board *board, enum color color) {
+    const uint8_t *cnts = board->piece_cnts[color];
+    const int *values = eval_params.piece_values;
+
+    return values[KNIGHT] * cnts[KNIGHT] + values[BISHOP] * cnts[BISHOP]
+         + values[ROOK] * cnts[ROOK] + values[QUEEN] * cnts[QUEEN];
+}
+
+eg_eval_fn * eg_get_eval(struct board *board, enum color *strong) {
+    assert(board != NULL);
+    assert(strong != NULL);
+
+    for (size_t i = 0; i < eg_entries_cnt; ++i) {
+        if (eg_entries[i].key == board->material_key) {
+            *strong = eg_entries[i].strong;
+            return eg_entries[i].eval;
+        }
+    }
+
+    for (enum color color = WHITE; color < COLOR_CNT; ++color) {
+        enum color other = color_flip(color);
+
+        // a lone king against at least a rook's worth of pieces
+        if (bb_bit_cnt(board->bb_pieces[other][BB_ALL]) == 1
+         && eg_non_pawn_material(board, color) >= eval_params.piece_values[ROOK]) {
+            *strong = color;
+            return eg_eval_kxk;
+        }
+    }
+
+    return NULL;
+}
+
+eg_scale_fn * eg_get_scale(struct board *board, enum color strong) {
+    assert(board != NULL);
+
+    const uint8_t *cnts = board->piece_cnts[strong];
+    const uint8_t *cnts_other = board->piece_cnts[color_flip(strong)];
+
+    bool lone_bishop = cnts[BISHOP] == 1 && cnts[KNIGHT] + cnts[ROOK] + cnts[QUEEN] == 0;
+    bool lone_bishop_other = cnts_other[BISHOP] == 1 && cnts_other[KNIGHT] + cnts_other[ROOK] + cnts_other[QUEEN] == 0;
+
+    if (lone_bishop && lone_bishop_other) {
+        return eg_scale_opposite_bishops;
+    }
+
+    // pawns with at most a bishop
+    if (cnts[PAWN] > 0 && cnts[BISHOP] <= 1 && cnts[KNIGHT] + cnts[ROOK] + cnts[QUEEN] == 0) {
+        return eg_scale_rook_pawns;
+    }
+
+    return NULL;
+}
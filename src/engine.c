@@ -3,11 +3,18 @@
 #include "bitboard.h"
 #include "board.h"
 #include "book.h"
+#include "dfpn.h"
+#include "endgame.h"
 #include "eval.h"
+#include "evalcache.h"
+#include "mcts.h"
+#include "nnue.h"
 #include "pst.h"
 #include "search.h"
+#include "tt.h"
 #include "xboard.h"
 #include "xboard-out-cmds.h"
+#include "zobrist.h"
 
 #include <assert.h>
 #include <stdbool.h>
@@ -20,6 +27,11 @@ void engine_init(const char *name) {
     assert(name != NULL);
 
     bb_init(); // initialize bitboard static data
+    zb_init(); // initialize Zobrist keys
+    tt_init(); // initialize transposition table
+    ec_init(); // initialize evaluation cache
+    nnue_init(); // select the NNUE inference kernels
+    eg_init(); // register specialized endgames
     bk_init(); // initialize opening book
     xb_init(); // initialize xboard static data
 
@@ -67,7 +79,15 @@ void engine_init(const char *name) {
     xboard->features[XB_FEATURE_DONE]->i      = -1;
 
     engine.hard = true;
-    engine.post = false;
+    engine.analyze = false;
+    engine.search_options.algorithm = SEARCH_ALGORITHM_PVS;
+    engine.search_options.time_limit = SEARCH_TIME_LIMIT;
+    engine.search_options.nps = 0;
+    engine.search_options.threads = 1;
+    engine.search_options.stop_poll = NULL;
+    engine.search_options.multi_pv = 1;
+    engine.search_options.post = false;
+    engine.search_options.excluded_cnt = 0;
 
     engine_reset();
 }
@@ -77,6 +97,12 @@ void engine_term(void) {
 
     xb_term();
     bk_term();
+    mcts_term();
+    dfpn_term();
+    search_term();
+    ec_term();
+    nnue_term();
+    tt_term();
     bb_term();
 }
 
@@ -89,6 +115,12 @@ void engine_reset(void) {
     engine.time_other = -1;
 
     board_reset(&engine.board);
+
+    // a new game drops the depth limit set by `sd`
+    engine.search_options.depth = SEARCH_DEPTH;
+    engine.search_options.excluded_cnt = 0;
+
+    tt_clear();
 }
 
 void engine_recv_move(struct move move) {
@@ -96,6 +128,9 @@ void engine_recv_move(struct move move) {
 
     board_do_move(board, move);
 
+    // exclusions only apply to the position they were made in
+    engine.search_options.excluded_cnt = 0;
+
     board_print_fancy(board);
 }
 
@@ -106,7 +141,7 @@ void engine_send_move(void) {
 
     if (move.flags == MOVE_FLAG_INVALID) {
         xb_commentln("MOVE NOT IN BOOK");
-        move = search_best_move(board);
+        move = search_best_move(board, &engine.search_options, NULL);
 
         if (move.flags == MOVE_FLAG_INVALID) {
             xb_out_cmd(XB_OUT_CMD_RESIGN);
@@ -116,7 +151,23 @@ void engine_send_move(void) {
 
     board_do_move(board, move);
 
+    engine.search_options.excluded_cnt = 0;
+
     xb_out_cmd(XB_OUT_CMD_MOVE, move); // send the move to xboard
 
     board_print_fancy(board);
 }
+
+void engine_analyze(void) {
+    struct search_options options = engine.search_options;
+
+    // thinking output is always sent in analyze mode
+    options.post = true;
+
+    // the analysis goes on until the next command arrives
+    options.depth = SEARCH_DEPTH_MAX;
+    options.time_limit = 0;
+    options.stop_poll = xb_input_pending;
+
+    search_best_move(&engine.board, &options, NULL);
+}
@@ -1,11 +1,14 @@
 #include "eval.h"
 #include "engine.h"
 #include "bitboard.h"
+#include "evalparams.h"
+#include "nnue.h"
 
 #include <assert.h>
+#include <limits.h>
 
 bb_t adjacent_files[FL_CNT] = {
-    [FL_A] = file_base << FL_A,
+    [FL_A] = file_base << FL_B,
     [FL_B] = file_base << FL_A | file_base << FL_C,
     [FL_C] = file_base << FL_B | file_base << FL_D,
     [FL_D] = file_base << FL_C | file_base << FL_E,
@@ -16,6 +19,14 @@ bb_t adjacent_files[FL_CNT] = {
 };
 bb_t pawn_shields[COLOR_CNT][SQ_CNT];
 
+static __thread struct pawn_entry *pawn_table = NULL; // pawn hash table of the current thread
+static __thread struct material_entry *material_table = NULL; // material hash table of the current thread
+
+void eval_set_tables(struct pawn_entry *pawn_table_, struct material_entry *material_table_){
+    pawn_table = pawn_table_;
+    material_table = material_table_;
+}
+
 void init_shields(void){
     for(enum square sq = SQ_A1; sq < SQ_CNT; sq++){
         bb_t bb_square = bb_squares[sq];
@@ -27,62 +38,192 @@ void init_shields(void){
     }
 }
 
-enum piece_value get_piece_value(enum piece piece){
+int get_piece_value(enum piece piece){
     assert(piece > PIECE_NONE && piece < PIECE_CNT);
 
-    switch(piece){
-        case PAWN:      return PAWN_VALUE;
-        case KNIGHT:    return KNIGHT_VALUE;
-        case BISHOP:    return BISHOP_VALUE;
-        case ROOK:      return ROOK_VALUE;
-        case QUEEN:     return QUEEN_VALUE;
-        default:        return 0;
+    return eval_params.piece_values[piece];
+}
+
+int static_exchange_evaluation(struct board *board, struct move move){
+    assert(board != NULL);
+
+    // the king is given a prohibitive value so that capturing
+    // with it into a defended square never pays off
+    int see_values[PIECE_CNT];
+
+    for(enum piece p = 0; p < PIECE_CNT; p++)
+        see_values[p] = p == KING ? 20 * get_piece_value(QUEEN) : get_piece_value(p);
+    static const enum piece attackers_order[PIECE_CNT] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+    int gain[33]; // at most 32 pieces take part in the exchange
+    int d = 0;
+
+    enum color color = color_flip(board->color);
+    enum piece attacker = move.piece;
+
+    bb_t bb_occ = board->bb_pieces[WHITE][BB_ALL] | board->bb_pieces[BLACK][BB_ALL];
+
+    gain[0] = 0;
+
+    if(move.flags & MOVE_FLAG_CAPTURE)
+        gain[0] = see_values[move.capture];
+
+    if(move.flags & MOVE_FLAG_EN_PASSANT){
+        gain[0] = see_values[PAWN];
+        bb_occ ^= bb_squares[move.to + (board->color == WHITE ? -FL_CNT : FL_CNT)];
+    }
+
+    if(move.flags & MOVE_FLAG_PROMOTION){
+        gain[0] += see_values[move.promotion] - see_values[PAWN];
+        attacker = move.promotion;
     }
+
+    bb_occ ^= bb_squares[move.from];
+
+    bb_t bb_attackers = board_get_attackers(board, move.to, bb_occ) & bb_occ;
+
+    bb_t bb_rooks = board->bb_pieces[WHITE][BB_ROOKS] | board->bb_pieces[BLACK][BB_ROOKS]
+                  | board->bb_pieces[WHITE][BB_QUEENS] | board->bb_pieces[BLACK][BB_QUEENS];
+    bb_t bb_bishops = board->bb_pieces[WHITE][BB_BISHOPS] | board->bb_pieces[BLACK][BB_BISHOPS]
+                    | board->bb_pieces[WHITE][BB_QUEENS] | board->bb_pieces[BLACK][BB_QUEENS];
+
+    while(true){
+        d++;
+
+        // speculative score if the piece on the square gets captured
+        gain[d] = see_values[attacker] - gain[d - 1];
+
+        // neither side can improve its result by continuing
+        if((-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]) < 0)
+            break;
+
+        bb_t bb_color_attackers = bb_attackers & board->bb_pieces[color][BB_ALL];
+
+        if(bb_color_attackers == BB_EMPTY)
+            break;
+
+        for(size_t i = 0; i < PIECE_CNT; i++){
+            bb_t bb = bb_color_attackers & board->bb_pieces[color][attackers_order[i]];
+
+            if(bb){
+                attacker = attackers_order[i];
+                bb_occ ^= bb & -bb;
+                break;
+            }
+        }
+
+        // reveal sliding pieces hidden behind the piece that just captured
+        bb_attackers |= (bb_get_attacks(color, ROOK, move.to, bb_occ) & bb_rooks)
+                      | (bb_get_attacks(color, BISHOP, move.to, bb_occ) & bb_bishops);
+        bb_attackers &= bb_occ;
+
+        color = color_flip(color);
+    }
+
+    // the last speculative score is discarded
+    while(--d > 0)
+        gain[d - 1] = -(-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]);
+
+    return gain[0];
 }
 
-int get_mobility(struct board *board, enum color color){
+/**
+ * Returns the value of the pieces other than pawns of the given color.
+ */
+static int get_non_pawn_material(struct board *board, enum color color){
+    const uint8_t *cnts = board->piece_cnts[color];
+
+    const int *values = eval_params.piece_values;
+
+    return values[KNIGHT] * cnts[KNIGHT] + values[BISHOP] * cnts[BISHOP]
+         + values[ROOK] * cnts[ROOK] + values[QUEEN] * cnts[QUEEN];
+}
+
+const struct material_entry * probe_material(struct board *board, struct material_entry *entry){
     assert(board != NULL);
-    
-    int total_mobility = 0;
+    assert(entry != NULL);
 
-    // Pawns have multiple move types so it's a special case.
-    bb_t bb_pawns = board->bb_pieces[color][BB_PAWNS];
-    bb_t pawn_single_pushes = BB_EMPTY, pawn_double_pushes = BB_EMPTY, pawn_attacks = BB_EMPTY;
-    bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_flip(color)][BB_ALL];
+    if(material_table != NULL){
+        entry = &material_table[board->material_key & (MATERIAL_TABLE_CNT-1)];
 
-    if(color == WHITE){
-        pawn_single_pushes = (bb_pawns << 8) & ~bb_occ;
-        pawn_double_pushes = ((pawn_single_pushes && bb_ranks[RK_3]) << 8) & ~bb_occ;
+        // unlike the pawn key, the material key is never empty (there are kings)
+        if(entry->key == board->material_key)
+            return entry;
     }
-    if(color == BLACK){
-        pawn_single_pushes = (bb_pawns >> 8) & ~bb_occ;
-        pawn_double_pushes = ((pawn_single_pushes && bb_ranks[RK_6]) >> 8) & ~bb_occ;
+
+    entry->key = board->material_key;
+    entry->score = SCORE_ZERO;
+    entry->phase = 0;
+
+    for(enum color color = WHITE; color < COLOR_CNT; color++){
+        const uint8_t *cnts = board->piece_cnts[color];
+
+        int material = eval_params.piece_values[PAWN] * cnts[PAWN] + get_non_pawn_material(board, color);
+
+        score_t score = SCORE(material, material);
+
+        // Imbalance
+
+        score += cnts[BISHOP] >= 2 ? eval_params.bishop_pair_bonus : SCORE_ZERO;
+
+        score += (eval_params.knight_pawn_bonus * cnts[KNIGHT] + eval_params.rook_pawn_penalty * cnts[ROOK]) * (cnts[PAWN] - 5);
+
+        entry->score += color == WHITE ? score : -score;
+
+        entry->phase += KNIGHT_PHASE * cnts[KNIGHT] + BISHOP_PHASE * cnts[BISHOP]
+                      + ROOK_PHASE * cnts[ROOK] + QUEEN_PHASE * cnts[QUEEN];
     }
 
-    while(bb_pawns){
-        enum square from = bb_pop_lsb(&bb_pawns);
+    // promotions can take the phase above its initial value
+    if(entry->phase > PHASE_MAX)
+        entry->phase = PHASE_MAX;
+
+    // Scale
+
+    for(enum color color = WHITE; color < COLOR_CNT; color++){
+        int npm = get_non_pawn_material(board, color);
+        int npm_other = get_non_pawn_material(board, color_flip(color));
+
+        entry->scale[color] = SCALE_NORMAL;
+        entry->scale_fns[color] = eg_get_scale(board, color);
+
+        // without pawns, being at most a minor piece ahead is rarely enough
+        // to win and a single minor piece can never mate
+        int bishop_value = eval_params.piece_values[BISHOP];
 
-        pawn_attacks |= bb_get_attacks(color, PAWN, from, BB_EMPTY);
+        if(board->piece_cnts[color][PAWN] == 0 && npm - npm_other <= bishop_value)
+            entry->scale[color] = npm < eval_params.piece_values[ROOK] ? SCALE_DRAW : npm_other <= bishop_value ? 4 : 14;
     }
 
-    // pawn_attacks &= ~bb_occ;
-    pawn_attacks &= ~board->bb_pieces[color][BB_ALL];
-    pawn_attacks &= board->bb_pieces[color_flip(color)][BB_ALL];
+    // Specialized endgames
 
-    total_mobility += bb_bit_cnt(pawn_single_pushes | pawn_double_pushes | pawn_attacks);
+    entry->endgame = eg_get_eval(board, &entry->endgame_strong);
 
-    // The rest of the pieces.
-    for(enum piece p = 0; p < PAWN; p++){
-        bb_t bb_piece = board->bb_pieces[color][p];
+    return entry;
+}
 
-        while(bb_piece){
-            enum square from = bb_pop_lsb(&bb_piece);
+int get_mobility(struct board *board, enum color color){
+    assert(board != NULL);
 
-            bb_t bb_attacks = bb_get_attacks(color, p, from, bb_occ);
-            bb_attacks &= ~board->bb_pieces[color][BB_ALL];
+    const struct board_attacks *attacks = board_get_attack_maps(board);
 
-            total_mobility += bb_bit_cnt(bb_attacks);
-        }
+    bb_t bb_own = board->bb_pieces[color][BB_ALL];
+    bb_t bb_occ = bb_own | board->bb_pieces[color_flip(color)][BB_ALL];
+
+    // Pawns have multiple move types so it's a special case.
+    bb_t pawn_single_pushes = bb_shift_forward(color, board->bb_pieces[color][BB_PAWNS]) & ~bb_occ;
+    bb_t pawn_double_pushes = bb_shift_forward(color, pawn_single_pushes & bb_ranks[color == WHITE ? RK_3 : RK_6]) & ~bb_occ;
+    bb_t pawn_attacks = attacks->by_piece[color][PAWN] & board->bb_pieces[color_flip(color)][BB_ALL];
+
+    int total_mobility = bb_bit_cnt(pawn_single_pushes | pawn_double_pushes | pawn_attacks);
+
+    // The rest of the pieces.
+    bb_t bb_pieces = bb_own & ~board->bb_pieces[color][BB_PAWNS];
+
+    while(bb_pieces){
+        enum square from = bb_pop_lsb(&bb_pieces);
+
+        total_mobility += bb_bit_cnt(attacks->by_square[from] & ~bb_own);
     }
 
     return total_mobility;
@@ -111,126 +252,218 @@ bool has_bishop_pair(struct board *board, enum color color){
 
 int get_rooks_on_open_files(struct board *board, enum color color){
     assert(board != NULL);
-    
-    int rooks = 0;
 
     bb_t bb_rooks = board->bb_pieces[color][BB_ROOKS];
     bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_flip(color)][BB_ALL];
 
-    for(enum file file = FL_A; file < FL_CNT; file++){
-        bb_t bb_file = bb_files[file];
+    // files holding any piece other than the rooks of the color are not open
+    bb_t bb_open_rooks = bb_rooks & ~bb_fill_files(bb_occ & ~bb_rooks);
 
-        if((bb_file & bb_rooks) && ((bb_file & bb_rooks) == (bb_file & bb_occ)))
-            rooks++;
-    }
+    // rooks doubled on an open file count once
+    return bb_bit_cnt(bb_fill_files(bb_open_rooks) & bb_ranks[RK_1]);
+}
 
-    return rooks;
+/**
+ * Returns the files (as squares of the first rank) holding pawns of the given bitboard.
+ */
+static inline bb_t get_pawn_files(bb_t bb_pawns){
+    return bb_fill_files(bb_pawns) & bb_ranks[RK_1];
+}
+
+/**
+ * Returns the files (as squares of the first rank) among the given ones
+ * whose adjacent files are not among them.
+ */
+static inline bb_t get_isolated_files(bb_t bb_files_){
+    return bb_files_ & ~bb_shift_east(bb_files_) & ~bb_shift_west(bb_files_);
 }
 
 int get_isolated_pawns(struct board *board, enum color color){
     assert(board != NULL);
 
-    int isolated_pawns = 0;
+    return bb_bit_cnt(get_isolated_files(get_pawn_files(board->bb_pieces[color][BB_PAWNS])));
+}
+
+int get_doubled_pawns(struct board *board, enum color color){
+    assert(board != NULL);
 
     bb_t bb_pawns = board->bb_pieces[color][BB_PAWNS];
 
-    for(enum file file = FL_A; file < FL_CNT; file++){
-        bb_t file_mask = bb_files[file];
-        bb_t adjacent_files_mask = adjacent_files[file];
+    // every pawn beyond the first one of its file is doubled
+    return bb_bit_cnt(bb_pawns) - bb_bit_cnt(get_pawn_files(bb_pawns));
+}
+
+int get_backward_pawns(struct board *board, enum color color){
+    assert(board != NULL);
 
-        if((file_mask & bb_pawns) && !(adjacent_files_mask & bb_pawns))
-            isolated_pawns++;
-    }
+    enum color color_other = color_flip(color);
+
+    bb_t bb_own_pawns = board->bb_pieces[color][BB_PAWNS];
+    bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_other][BB_ALL];
+
+    bb_t stop_squares = bb_shift_forward(color, bb_own_pawns) & ~bb_occ;
 
-    return isolated_pawns;
+    return bb_bit_cnt(stop_squares & ~bb_pawn_attacks_set(color, bb_own_pawns)
+                                   & bb_pawn_attacks_set(color_other, board->bb_pieces[color_other][BB_PAWNS]));
 }
 
-int get_doubled_pawns(struct board *board, enum color color){
-    assert(board != NULL);
+/**
+ * Computes all the pawn structure terms of both colors into the given entry
+ * in a single pass, from file fills and front spans of whole pawn sets
+ * (the pawn attacks of each color are shared by the terms of both colors).
+ */
+static void eval_pawns(struct board *board, struct pawn_entry *entry){
+    bb_t bb_pawns[COLOR_CNT], pawn_files[COLOR_CNT], pawn_attacks[COLOR_CNT];
+
+    for(enum color color = WHITE; color < COLOR_CNT; color++){
+        bb_pawns[color] = board->bb_pieces[color][BB_PAWNS];
+        pawn_files[color] = get_pawn_files(bb_pawns[color]);
+        pawn_attacks[color] = bb_pawn_attacks_set(color, bb_pawns[color]);
+    }
 
-    int doubled_pawns = 0;
+    entry->score = SCORE_ZERO;
 
-    bb_t bb_pawns = board->bb_pieces[color][BB_PAWNS];
+    for(enum color color = WHITE; color < COLOR_CNT; color++){
+        enum color color_other = color_flip(color);
+
+        int isolated_pawns = bb_bit_cnt(get_isolated_files(pawn_files[color]));
+        int doubled_pawns = bb_bit_cnt(bb_pawns[color]) - bb_bit_cnt(pawn_files[color]);
+
+        score_t score = eval_params.isolated_pawn_penalty * isolated_pawns + eval_params.doubled_pawn_penalty * doubled_pawns;
+
+        // stop squares not defended by own pawns but attacked by the opponent ones
+        entry->backward_stops[color] = bb_shift_forward(color, bb_pawns[color])
+                                     & ~pawn_attacks[color] & pawn_attacks[color_other];
 
-    for(enum file file = FL_A; file < FL_CNT; file++){
-        int pawns_on_file = bb_bit_cnt(bb_files[file] & bb_pawns);
+        // passed pawns have no opponent pawns in front of them on their
+        // own and adjacent files (nor any own pawn in front of them)
+        bb_t bb_stoppers = bb_span_front(color_other, bb_pawns[color_other])
+                         | pawn_attacks[color_other] | bb_span_front(color_other, pawn_attacks[color_other]);
 
-        if(pawns_on_file > 1)
-            doubled_pawns += (pawns_on_file - 1);
+        bb_t bb_passed = bb_pawns[color] & ~bb_stoppers & ~bb_span_rear(color, bb_pawns[color]);
+
+        while(bb_passed){
+            enum rank rank = square_to_rank(bb_pop_lsb(&bb_passed));
+
+            score += eval_params.passed_pawn_bonus[color == WHITE ? rank : RK_8 - rank];
+        }
+
+        entry->score += color == WHITE ? score : -score;
     }
+}
+
+/**
+ * Returns the pawn hash table entry of the given board, computing its terms
+ * if they are not cached. Without a pawn hash table `entry` is filled in.
+ */
+static const struct pawn_entry * probe_pawns(struct board *board, struct pawn_entry *entry){
+    // an entry still zeroed matches the (empty) key of a board without pawns
+    // and holds the right terms for it
+    if(pawn_table != NULL){
+        entry = &pawn_table[board->pawn_key & (PAWN_TABLE_CNT-1)];
+
+        if(entry->key == board->pawn_key)
+            return entry;
+    }
+
+    entry->key = board->pawn_key;
 
-    return doubled_pawns;
+    eval_pawns(board, entry);
+
+    return entry;
 }
 
-int get_backward_pawns(struct board *board, enum color color){
-    assert(board != NULL);
+/**
+ * Returns the score (from the perspective of the given color) of the given
+ * packed score, its endgame part scaled by the material entry (or its
+ * specialized scale function) and both parts blended by game phase.
+ */
+static int blend_score(struct board *board, score_t score, const struct material_entry *material, enum color color){
+    int mg = score_mg(score);
+    int eg = score_eg(score);
 
-    bb_t bb_own_pawns = board->bb_pieces[color][BB_PAWNS];
-    bb_t bb_op_pawns = board->bb_pieces[color_flip(color)][BB_PAWNS];
-    bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_flip(color)][BB_ALL];
+    // Scale
 
-    bb_t stop_squares = BB_EMPTY, own_pawn_attacks = BB_EMPTY, op_pawn_attacks = BB_EMPTY;
+    enum color color_ahead = eg > 0 ? color : color_flip(color);
 
-    if(color == WHITE){
-        stop_squares = (bb_own_pawns << 8) & ~bb_occ;
-        own_pawn_attacks = ((bb_own_pawns << 7) & ~bb_files[FL_H]) | ((bb_own_pawns << 9) & ~bb_files[FL_A]);
-        op_pawn_attacks = ((bb_op_pawns >> 7) & ~bb_files[FL_A]) | ((bb_op_pawns >> 9) & ~bb_files[FL_H]);
-    }
-    if(color == BLACK){
-        stop_squares = (bb_own_pawns >> 8) & ~bb_occ;
-        own_pawn_attacks = ((bb_own_pawns >> 7) & ~bb_files[FL_A]) | ((bb_own_pawns >> 9) & ~bb_files[FL_H]);
-        op_pawn_attacks = ((bb_op_pawns << 7) & ~bb_files[FL_H]) | ((bb_op_pawns << 9) & ~bb_files[FL_A]);
+    int scale = material->scale[color_ahead];
+
+    if(material->scale_fns[color_ahead] != NULL){
+        int specialized_scale = material->scale_fns[color_ahead](board, color_ahead);
+
+        if(specialized_scale != EG_SCALE_NONE)
+            scale = specialized_scale;
     }
 
-    return bb_bit_cnt(stop_squares & ~own_pawn_attacks & op_pawn_attacks);
+    eg = eg * scale / SCALE_NORMAL;
+
+    // Blend by game phase
+
+    return (mg * material->phase + eg * (PHASE_MAX - material->phase)) / PHASE_MAX;
 }
 
-int evaluate(struct board *board, enum color color){
+int evaluate_lazy(struct board *board, enum color color, int alpha, int beta){
     assert(board != NULL);
 
-    enum color color_other = color_flip(color);
+    struct material_entry material_entry;
+    const struct material_entry *material = probe_material(board, &material_entry);
+
+    // known endgames are evaluated by their specialized evaluation alone
+    if(material->endgame != NULL){
+        int score = material->endgame(board, material->endgame_strong);
 
-    int total_score = 0;
+        return color == material->endgame_strong ? score : -score;
+    }
 
-    // Piece values
+    // the network replaces the whole evaluation (it has no cheap part)
+    if(nnue_is_loaded())
+        return nnue_evaluate(board, color);
 
-    total_score += PAWN_VALUE * (bb_bit_cnt(board->bb_pieces[color][BB_PAWNS]) 
-                                - bb_bit_cnt(board->bb_pieces[color_other][BB_PAWNS]));
+    enum color color_other = color_flip(color);
 
-    total_score += KNIGHT_VALUE * (bb_bit_cnt(board->bb_pieces[color][BB_KNIGHTS]) 
-                                - bb_bit_cnt(board->bb_pieces[color_other][BB_KNIGHTS]));
+    score_t total_score = SCORE_ZERO;
 
-    total_score += BISHOP_VALUE * (bb_bit_cnt(board->bb_pieces[color][BB_BISHOPS]) 
-                                - bb_bit_cnt(board->bb_pieces[color_other][BB_BISHOPS]));
+    // Piece values and imbalance (bishop pair included)
 
-    total_score += ROOK_VALUE * (bb_bit_cnt(board->bb_pieces[color][BB_ROOKS]) 
-                                - bb_bit_cnt(board->bb_pieces[color_other][BB_ROOKS]));
-                                
-    total_score += QUEEN_VALUE * (bb_bit_cnt(board->bb_pieces[color][BB_QUEENS]) 
-                                - bb_bit_cnt(board->bb_pieces[color_other][BB_QUEENS]));
+    total_score += color == WHITE ? material->score : -material->score;
 
     // PST scores
     total_score += board->pst_scores[color]-board->pst_scores[color_other];
 
-    // Bonuses
+    // Lazy exit: the remaining terms are not expected to bring a score this
+    // far outside the window back into it (see LAZY_EVAL_MARGIN, a measured
+    // bound on them: in rare positions they do and the partial score is off)
+
+    int lazy_score = blend_score(board, total_score, material, color);
 
-    total_score += MOBILITY_BONUS * (get_mobility(board, color) - get_mobility(board, color_other));
+    if(lazy_score + LAZY_EVAL_MARGIN <= alpha || lazy_score - LAZY_EVAL_MARGIN >= beta)
+        return lazy_score;
+
+    // Bonuses
 
-    total_score += KING_PAWN_SHIELD_BONUS * (get_pawns_shielding_king(board, color) - get_pawns_shielding_king(board, color_other));
+    total_score += eval_params.mobility_bonus * (get_mobility(board, color) - get_mobility(board, color_other));
 
-    total_score += has_bishop_pair(board, color) ? BISHOP_PAIR_BONUS : 0;
+    total_score += eval_params.king_pawn_shield_bonus * (get_pawns_shielding_king(board, color) - get_pawns_shielding_king(board, color_other));
 
-    total_score += ROOK_OPEN_FILE_BONUS * (get_rooks_on_open_files(board, color) - get_rooks_on_open_files(board, color_other));
+    total_score += eval_params.rook_open_file_bonus * (get_rooks_on_open_files(board, color) - get_rooks_on_open_files(board, color_other));
 
     // Penalties
 
-    total_score += ISOLATED_PAWN_PENALTY * (get_isolated_pawns(board, color) - get_isolated_pawns(board, color_other));
+    struct pawn_entry pawn_entry;
+    const struct pawn_entry *pawns = probe_pawns(board, &pawn_entry);
 
-    total_score += DOUBLED_PAWN_PENALTY * (get_doubled_pawns(board, color) - get_doubled_pawns(board, color_other));
+    total_score += color == WHITE ? pawns->score : -pawns->score;
 
-    total_score += BACKWARD_PAWN_PENALTY * (get_backward_pawns(board, color) - get_backward_pawns(board, color_other)); 
+    // pawns blocked by any piece are not backward, so the cached
+    // stop squares are only filtered by the occupancy here
+    bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_other][BB_ALL];
 
-    total_score -= has_bishop_pair(board, color_other) ? BISHOP_PAIR_BONUS : 0;
+    total_score += eval_params.backward_pawn_penalty * (bb_bit_cnt(pawns->backward_stops[color] & ~bb_occ)
+                                                      - bb_bit_cnt(pawns->backward_stops[color_other] & ~bb_occ));
 
-    return total_score;
+    return blend_score(board, total_score, material, color);
+}
+
+int evaluate(struct board *board, enum color color){
+    return evaluate_lazy(board, color, INT_MIN, INT_MAX);
 }
@@ -0,0 +1,146 @@
+#include "evalcache.h"
+
+#include "zobrist.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Evaluation hash table:
+ * https://www.chessprogramming.org/Evaluation_Hash_Table
+ *
+ */
+
+/**
+ * Slot of the cache packing the upper half of the key (the lower half selects
+ * the slot) with the score into a single word, so that slots are read and
+ * written atomically and can never be torn by concurrent writes.
+ */
+typedef uint64_t ec_slot_t;
+
+/**
+ * Content of an empty slot (no evaluation is ever `INT32_MIN`).
+ */
+#define EC_SLOT_EMPTY ((ec_slot_t)(uint32_t)INT32_MIN)
+
+static ec_slot_t *ec_slots = NULL;
+static size_t ec_slots_cnt = 0; // 0 if the cache is disabled (power of 2 otherwise)
+
+static unsigned long long ec_hits = 0; // (atomic)
+static unsigned long long ec_misses = 0; // (atomic)
+
+static __thread unsigned long long ec_thread_hits = 0;
+static __thread unsigned long long ec_thread_misses = 0;
+
+void ec_init(void) {
+    ec_resize(EC_SIZE_DEFAULT);
+}
+
+void ec_term(void) {
+    free(ec_slots);
+
+    ec_slots = NULL;
+    ec_slots_cnt = 0;
+}
+
+void ec_resize(size_t size) {
+    assert(size <= EC_SIZE_MAX);
+
+    ec_term();
+
+    if (size == 0) {
+        ec_clear();
+        return;
+    }
+
+    // the largest power of 2 of slots fitting in the given size
+    ec_slots_cnt = 1;
+
+    while (2*ec_slots_cnt*sizeof(*ec_slots) <= size << 20) {
+        ec_slots_cnt *= 2;
+    }
+
+    ec_slots = malloc(ec_slots_cnt*sizeof(*ec_slots));
+
+    if (ec_slots == NULL) {
+        error(EXIT_FAILURE, errno, "could not allocate space for evaluation cache");
+    }
+
+    ec_clear();
+}
+
+void ec_clear(void) {
+    for (size_t i = 0; i < ec_slots_cnt; ++i) {
+        __atomic_store_n(&ec_slots[i], EC_SLOT_EMPTY, __ATOMIC_RELAXED);
+    }
+
+    ec_hits = 0;
+    ec_misses = 0;
+
+    ec_thread_hits = 0;
+    ec_thread_misses = 0;
+}
+
+bool ec_probe(zb_key_t key, int *score) {
+    assert(score != NULL);
+
+    if (ec_slots_cnt == 0) {
+        return false;
+    }
+
+    ec_slot_t slot = __atomic_load_n(&ec_slots[key & (ec_slots_cnt-1)], __ATOMIC_RELAXED);
+
+    if ((slot >> 32) != (uint32_t)(key >> 32) || (uint32_t)slot == (uint32_t)INT32_MIN) {
+        ec_thread_misses++;
+        return false;
+    }
+
+    *score = (int32_t)(uint32_t)slot;
+
+    ec_thread_hits++;
+
+    return true;
+}
+
+void ec_prefetch(zb_key_t key) {
+    if (ec_slots_cnt == 0) {
+        return;
+    }
+
+    __builtin_prefetch(&ec_slots[key & (ec_slots_cnt-1)]);
+}
+
+void ec_store(zb_key_t key, int score) {
+    assert(score != INT32_MIN);
+
+    if (ec_slots_cnt == 0) {
+        return;
+    }
+
+    ec_slot_t slot = (uint64_t)(uint32_t)(key >> 32) << 32 | (uint32_t)score;
+
+    __atomic_store_n(&ec_slots[key & (ec_slots_cnt-1)], slot, __ATOMIC_RELAXED);
+}
+
+void ec_flush_stats(void) {
+    __atomic_fetch_add(&ec_hits, ec_thread_hits, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ec_misses, ec_thread_misses, __ATOMIC_RELAXED);
+
+    ec_thread_hits = 0;
+    ec_thread_misses = 0;
+}
+
+void ec_get_stats(unsigned long long *hits, unsigned long long *misses) {
+    assert(hits != NULL);
+    assert(misses != NULL);
+
+    *hits = __atomic_load_n(&ec_hits, __ATOMIC_RELAXED);
+    *misses = __atomic_load_n(&ec_misses, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,332 @@
+#include "evalparams.h"
+
+#include "pst.h"
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Description of a parameter: its name (in parameter files and options),
+ * its field in `struct eval_params` and its number of values.
+ */
+struct ep_param {
+    const char *name;
+    const char *field; // designator of the field (in the generated header)
+    size_t offset;
+    size_t cnt; // number of ints or packed scores
+    bool packed; // packed scores (two values each) instead of ints
+};
+
+#define EP_PARAM(name, field, cnt, packed) { name, #field, offsetof(struct eval_params, field), cnt, packed }
+
+static const struct ep_param ep_params[] = {
+    EP_PARAM("PawnValue",           piece_values[PAWN],     1, false),
+    EP_PARAM("KnightValue",         piece_values[KNIGHT],   1, false),
+    EP_PARAM("BishopValue",         piece_values[BISHOP],   1, false),
+    EP_PARAM("RookValue",           piece_values[ROOK],     1, false),
+    EP_PARAM("QueenValue",          piece_values[QUEEN],    1, false),
+
+    EP_PARAM("MobilityBonus",       mobility_bonus,         1, true),
+    EP_PARAM("KingPawnShieldBonus", king_pawn_shield_bonus, 1, true),
+    EP_PARAM("BishopPairBonus",     bishop_pair_bonus,      1, true),
+    EP_PARAM("RookOpenFileBonus",   rook_open_file_bonus,   1, true),
+    EP_PARAM("KnightPawnBonus",     knight_pawn_bonus,      1, true),
+
+    EP_PARAM("IsolatedPawnPenalty", isolated_pawn_penalty,  1, true),
+    EP_PARAM("DoubledPawnPenalty",  doubled_pawn_penalty,   1, true),
+    EP_PARAM("BackwardPawnPenalty", backward_pawn_penalty,  1, true),
+    EP_PARAM("RookPawnPenalty",     rook_pawn_penalty,      1, true),
+
+    EP_PARAM("PassedPawnBonus",     passed_pawn_bonus,      RK_CNT, true),
+
+    EP_PARAM("PawnPst",             pst[PAWN],              SQ_CNT, true),
+    EP_PARAM("KnightPst",           pst[KNIGHT],            SQ_CNT, true),
+    EP_PARAM("BishopPst",           pst[BISHOP],            SQ_CNT, true),
+    EP_PARAM("RookPst",             pst[ROOK],              SQ_CNT, true),
+    EP_PARAM("QueenPst",            pst[QUEEN],             SQ_CNT, true),
+    EP_PARAM("KingPst",             pst[KING],              SQ_CNT, true),
+};
+
+#define EP_PARAMS_CNT (sizeof(ep_params)/sizeof(*ep_params))
+
+/**
+ * Number of packed scores printed on a line of an array.
+ */
+#define EP_LINE_CNT 8
+
+#ifdef TUNE
+
+/**
+ * Values the engine was built with.
+ */
+static const struct eval_params ep_default = {
+#include "evalparams-gen.h"
+};
+
+struct eval_params eval_params = {
+#include "evalparams-gen.h"
+};
+
+#endif
+
+/**
+ * Get the number of values of a parameter.
+ */
+static size_t ep_values_cnt(const struct ep_param *param) {
+    return param->packed ? 2*param->cnt : param->cnt;
+}
+
+/**
+ * Get value `i` of a parameter.
+ */
+static int ep_get(const struct eval_params *params, const struct ep_param *param, size_t i) {
+    assert(i < ep_values_cnt(param));
+
+    const char *base = (const char *)params + param->offset;
+
+    if (!param->packed) {
+        return ((const int *)base)[i];
+    }
+
+    score_t score = ((const score_t *)base)[i/2];
+
+    return i % 2 == 0 ? score_mg(score) : score_eg(score);
+}
+
+#ifdef TUNE
+
+/**
+ * Set value `i` of a parameter.
+ */
+static void ep_set_value(struct eval_params *params, const struct ep_param *param, size_t i, int value) {
+    assert(i < ep_values_cnt(param));
+    assert(value >= -EP_VALUE_MAX && value <= EP_VALUE_MAX);
+
+    char *base = (char *)params + param->offset;
+
+    if (!param->packed) {
+        ((int *)base)[i] = value;
+        return;
+    }
+
+    score_t *score = &((score_t *)base)[i/2];
+
+    *score = i % 2 == 0 ? SCORE(value, score_eg(*score)) : SCORE(score_mg(*score), value);
+}
+
+/**
+ * Find the parameter named by the first `len` characters of `name`
+ * (`NULL` if there is none).
+ */
+static const struct ep_param * ep_find(const char *name, size_t len) {
+    for (size_t i = 0; i < EP_PARAMS_CNT; ++i) {
+        if (strlen(ep_params[i].name) == len && strncmp(ep_params[i].name, name, len) == 0) {
+            return &ep_params[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Parse a parameter value from the given string, advancing it past the value.
+ * Returns `false` if there is no valid value.
+ */
+static bool ep_parse_value(const char **str, int *value) {
+    char *end;
+    long val = strtol(*str, &end, 10);
+
+    if (end == *str || val < -EP_VALUE_MAX || val > EP_VALUE_MAX) {
+        return false;
+    }
+
+    *str = end;
+    *value = val;
+
+    return true;
+}
+
+/**
+ * Install the given parameters, recomputing the tables derived from them.
+ */
+static void ep_apply(const struct eval_params *params) {
+    eval_params = *params;
+
+    init_pst();
+}
+
+bool ep_load(const char *path) {
+    assert(path != NULL);
+
+    if (*path == '\0') {
+        ep_apply(&ep_default);
+        return true;
+    }
+
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    struct eval_params params = eval_params;
+
+    const struct ep_param *param = NULL;
+    size_t i = 0; // number of values of the parameter read so far
+
+    bool valid = true;
+
+    char token[64];
+
+    while (valid && fscanf(file, " %63s", token) == 1) {
+        if (token[0] == '#') {
+            // skip the rest of the comment line
+            fscanf(file, "%*[^\n]");
+            continue;
+        }
+
+        const char *str = token;
+        int value;
+
+        if (!ep_parse_value(&str, &value)) {
+            // a name starts the next parameter once the previous one is complete
+            valid = (param == NULL || i == ep_values_cnt(param))
+                 && (param = ep_find(token, strlen(token))) != NULL;
+            i = 0;
+            continue;
+        }
+
+        valid = *str == '\0' && param != NULL && i < ep_values_cnt(param);
+
+        if (valid) {
+            ep_set_value(&params, param, i++, value);
+        }
+    }
+
+    valid = valid && ferror(file) == 0 && (param == NULL || i == ep_values_cnt(param));
+
+    fclose(file);
+
+    if (valid) {
+        ep_apply(&params);
+    }
+
+    return valid;
+}
+
+bool ep_exists(const char *name) {
+    assert(name != NULL);
+
+    return ep_find(name, strcspn(name, "[")) != NULL;
+}
+
+bool ep_set(const char *name, const char *values) {
+    assert(name != NULL);
+    assert(values != NULL);
+
+    size_t len = strcspn(name, "[");
+
+    const struct ep_param *param = ep_find(name, len);
+
+    if (param == NULL) {
+        return false;
+    }
+
+    struct eval_params params = eval_params;
+
+    size_t first = 0, cnt = ep_values_cnt(param);
+
+    // `Name[i]` selects a single value
+    if (name[len] == '[') {
+        char *end;
+        unsigned long idx = strtoul(&name[len+1], &end, 10);
+
+        if (end == &name[len+1] || strcmp(end, "]") != 0 || idx >= cnt) {
+            return false;
+        }
+
+        first = idx;
+        cnt = 1;
+    }
+
+    for (size_t i = first; i < first + cnt; ++i) {
+        int value;
+
+        if (!ep_parse_value(&values, &value)) {
+            return false;
+        }
+
+        ep_set_value(&params, param, i, value);
+    }
+
+    // nothing may follow the values
+    while (isspace((unsigned char)*values)) {
+        values++;
+    }
+
+    if (*values != '\0') {
+        return false;
+    }
+
+    ep_apply(&params);
+
+    return true;
+}
+
+#endif
+
+void ep_print(FILE *file) {
+    assert(file != NULL);
+
+    fprintf(file, "# evaluation parameters (midgame and endgame values of packed scores)\n");
+
+    for (size_t i = 0; i < EP_PARAMS_CNT; ++i) {
+        const struct ep_param *param = &ep_params[i];
+
+        fprintf(file, "%s", param->name);
+
+        for (size_t j = 0; j < ep_values_cnt(param); ++j) {
+            fprintf(file, " %d", ep_get(&eval_params, param, j));
+        }
+
+        fprintf(file, "\n");
+    }
+}
+
+void ep_print_header(FILE *file) {
+    assert(file != NULL);
+
+    fprintf(file, "// Generated by `han-chesu params-header` (see `ep_print_header`), do not edit.\n\n");
+
+    for (size_t i = 0; i < EP_PARAMS_CNT; ++i) {
+        const struct ep_param *param = &ep_params[i];
+
+        // only packed scores come in arrays
+        assert(param->packed || param->cnt == 1);
+
+        if (!param->packed) {
+            fprintf(file, ".%s = %d,\n", param->field, ep_get(&eval_params, param, 0));
+            continue;
+        }
+
+        if (param->cnt == 1) {
+            fprintf(file, ".%s = SCORE(%d, %d),\n", param->field,
+                    ep_get(&eval_params, param, 0), ep_get(&eval_params, param, 1));
+            continue;
+        }
+
+        fprintf(file, ".%s = {\n", param->field);
+
+        for (size_t j = 0; j < param->cnt; ++j) {
+            fprintf(file, "%sSCORE(%d, %d),%s", j % EP_LINE_CNT == 0 ? "    " : "",
+                    ep_get(&eval_params, param, 2*j), ep_get(&eval_params, param, 2*j + 1),
+                    j % EP_LINE_CNT == EP_LINE_CNT-1 || j == param->cnt-1 ? "\n" : " ");
+        }
+
+        fprintf(file, "},\n");
+    }
+}
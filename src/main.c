@@ -1,17 +1,85 @@
+#include "bench.h"
+#include "dfpn.h"
 #include "engine.h"
+#include "evalparams.h"
+#include "search.h"
 #include "xboard.h"
 
+#include <error.h>
 #include <libgen.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-int main(int argc, char **argv) {
-    (void)argc;
+/**
+ * Parse the optional numeric argument `str` of a mode (`def` if it is `NULL`),
+ * exiting with an error unless the whole of it is a number from 1 to `max`.
+ */
+static int parse_count(const char *str, const char *name, int max, int def) {
+    if (str == NULL) {
+        return def;
+    }
+
+    char *end;
+    long value = strtol(str, &end, 10);
+
+    if (end == str || *end != '\0' || value < 1 || value > max) {
+        error(EXIT_FAILURE, 0, "invalid %s '%s'", name, str);
+    }
+
+    return value;
+}
 
+int main(int argc, char **argv) {
     char *engine_name = basename(argv[0]);
 
     engine_init(engine_name); // initialize engine
     atexit(engine_term); // register exit handler
 
+    // `bench [depth]` runs the speed benchmark instead of xboard
+    if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+        bench_run(parse_count(argc > 2 ? argv[2] : NULL, "depth", SEARCH_DEPTH_MAX, BENCH_DEPTH), "");
+
+        return EXIT_SUCCESS;
+    }
+
+    // `bench-smp [depth]` runs the parallel search benchmark instead of xboard
+    if (argc > 1 && strcmp(argv[1], "bench-smp") == 0) {
+        bench_smp(parse_count(argc > 2 ? argv[2] : NULL, "depth", SEARCH_DEPTH_MAX, BENCH_DEPTH));
+
+        return EXIT_SUCCESS;
+    }
+
+    // `mate <fen> [moves]` searches a forced mate in the given position
+    if (argc > 2 && strcmp(argv[1], "mate") == 0) {
+        dfpn_mate(argv[2], parse_count(argc > 3 ? argv[3] : NULL, "number of moves", DFPN_MATE_MAX, DFPN_MATE_DEFAULT));
+
+        return EXIT_SUCCESS;
+    }
+
+    // `params [file]` and `params-header [file]` print the evaluation parameters
+    // (those of the parameter file, in tuning builds) as a parameter file or as
+    // the generated header release builds take them from
+    if (argc > 1 && (strcmp(argv[1], "params") == 0 || strcmp(argv[1], "params-header") == 0)) {
+        if (argc > 2) {
+#ifdef TUNE
+            if (!ep_load(argv[2])) {
+                error(EXIT_FAILURE, 0, "invalid parameter file '%s'", argv[2]);
+            }
+#else
+            error(EXIT_FAILURE, 0, "parameter files can only be loaded by tuning builds (TUNE=1)");
+#endif
+        }
+
+        if (strcmp(argv[1], "params") == 0) {
+            ep_print(stdout);
+        } else {
+            ep_print_header(stdout);
+        }
+
+        return EXIT_SUCCESS;
+    }
+
     xb_loop(); // start xboard loop
 
     return EXIT_SUCCESS;
@@ -0,0 +1,371 @@
+#include "mcts.h"
+
+#include "board.h"
+#include "eval.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Monte-Carlo tree search:
+ * https://www.chessprogramming.org/Monte-Carlo_Tree_Search
+ *
+ * PUCT:
+ * https://www.chessprogramming.org/Christopher_D._Rosin#PUCT
+ *
+ * Virtual loss:
+ * https://www.chessprogramming.org/Parallel_Search#MCTS
+ *
+ */
+
+/**
+ * Value of a won playout (a lost one is worth the negated value).
+ */
+#define MCTS_VALUE_ONE 1000
+
+/**
+ * Value representing the expansion state of a node.
+ */
+enum mcts_state {
+    MCTS_STATE_LEAF,      // children not generated yet
+    MCTS_STATE_EXPANDING, // children being generated by some thread
+    MCTS_STATE_EXPANDED,  // children generated (none for terminal nodes)
+};
+
+/**
+ * Structure representing a node of the tree.
+ * The fields marked as atomic are shared between the threads growing the tree;
+ * the children fields are published by setting the state to expanded.
+ */
+struct mcts_node {
+    struct move move; // move leading to this node
+
+    uint32_t children; // index of the first child in the pool
+    uint16_t children_cnt;
+
+    uint8_t state; // `enum mcts_state` (atomic)
+
+    int16_t prior; // probability of `move` being the best one (in thousandths)
+
+    int32_t visits; // (atomic)
+
+    // sum of the playout results from the point of view
+    // of the side that made `move` (atomic)
+    int64_t value;
+};
+
+static struct mcts_node *mcts_nodes = NULL;
+static uint32_t mcts_nodes_cnt = 0; // number of pool nodes in use (atomic)
+
+static unsigned long long mcts_playouts = 0; // (atomic)
+
+/**
+ * Map a score in centipawns to a playout value.
+ */
+static int mcts_score_to_value(int score) {
+    return lround(MCTS_VALUE_ONE * (2.0 / (1.0 + exp(-(double)score / MCTS_SCORE_SCALE)) - 1.0));
+}
+
+/**
+ * Map an average playout value back to a score in centipawns.
+ */
+static int mcts_value_to_score(double value) {
+    if (value >= MCTS_VALUE_ONE) {
+        return INT_MAX / 2;
+    }
+
+    if (value <= -MCTS_VALUE_ONE) {
+        return INT_MIN / 2;
+    }
+
+    return lround(-MCTS_SCORE_SCALE * log(2.0 / (1.0 + value / MCTS_VALUE_ONE) - 1.0));
+}
+
+/**
+ * Generate the children of a node for the given moves, with priors given by
+ * the softmax of the static evaluation of the positions they lead to.
+ * Returns `false` if the node pool is exhausted.
+ */
+static bool mcts_expand(struct mcts_node *node, struct board *board, const struct move_list *moves) {
+    uint32_t first = __atomic_fetch_add(&mcts_nodes_cnt, moves->count, __ATOMIC_RELAXED);
+
+    if (first + moves->count > MCTS_NODE_CNT) {
+        return false;
+    }
+
+    int evals[MOVE_LIST_MAX];
+    int eval_max = INT_MIN;
+
+    for (size_t i = 0; i < moves->count; ++i) {
+        struct board board_copy = *board;
+        board_do_move(&board_copy, moves->list[i]);
+
+        evals[i] = -evaluate(&board_copy, board_copy.color);
+
+        if (evals[i] > eval_max) {
+            eval_max = evals[i];
+        }
+    }
+
+    double weights[MOVE_LIST_MAX];
+    double weights_sum = 0;
+
+    for (size_t i = 0; i < moves->count; ++i) {
+        weights[i] = exp((double)(evals[i] - eval_max) / MCTS_PRIOR_SCALE);
+        weights_sum += weights[i];
+    }
+
+    for (size_t i = 0; i < moves->count; ++i) {
+        struct mcts_node *child = &mcts_nodes[first + i];
+
+        child->move = moves->list[i];
+        child->children = 0;
+        child->children_cnt = 0;
+        child->state = MCTS_STATE_LEAF;
+        child->prior = lround(1000 * weights[i] / weights_sum);
+        child->visits = 0;
+        child->value = 0;
+    }
+
+    node->children = first;
+    node->children_cnt = moves->count;
+
+    __atomic_store_n(&node->state, MCTS_STATE_EXPANDED, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+/**
+ * Select the child of an expanded node maximizing the PUCT formula.
+ */
+static uint32_t mcts_select(struct mcts_node *node) {
+    assert(node->children_cnt > 0);
+
+    int32_t parent_visits = __atomic_load_n(&node->visits, __ATOMIC_RELAXED);
+    int64_t parent_value = __atomic_load_n(&node->value, __ATOMIC_RELAXED);
+
+    double sqrt_visits = sqrt(parent_visits > 0 ? parent_visits : 1);
+
+    // unvisited children are assumed to be somewhat worse than their parent
+    // (the parent value is negated since it belongs to the other side)
+    double fpu = (parent_visits > 0 ? -(double)parent_value / parent_visits : 0) -
+                 MCTS_FPU_REDUCTION * MCTS_VALUE_ONE / 1000.0;
+
+    uint32_t best = node->children;
+    double best_score = -INFINITY;
+
+    for (uint32_t i = node->children; i < node->children + node->children_cnt; ++i) {
+        struct mcts_node *child = &mcts_nodes[i];
+
+        int32_t visits = __atomic_load_n(&child->visits, __ATOMIC_RELAXED);
+        int64_t value = __atomic_load_n(&child->value, __ATOMIC_RELAXED);
+
+        double q = visits > 0 ? (double)value / visits : fpu;
+        double u = MCTS_CPUCT / 1000.0 * child->prior / 1000.0 * MCTS_VALUE_ONE * sqrt_visits / (1 + visits);
+
+        if (q + u > best_score) {
+            best_score = q + u;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+void mcts_term(void) {
+    free(mcts_nodes);
+    mcts_nodes = NULL;
+}
+
+void mcts_reset(struct board *board, const struct move_list *moves) {
+    assert(moves->count > 0);
+
+    if (mcts_nodes == NULL) {
+        mcts_nodes = malloc(MCTS_NODE_CNT*sizeof(*mcts_nodes));
+
+        if (mcts_nodes == NULL) {
+            error(EXIT_FAILURE, errno, "could not allocate space for search tree");
+        }
+    }
+
+    mcts_nodes_cnt = 1;
+    mcts_playouts = 0;
+
+    struct mcts_node *root = &mcts_nodes[0];
+
+    root->move.flags = MOVE_FLAG_INVALID;
+    root->state = MCTS_STATE_EXPANDING;
+    root->prior = 1000;
+    root->visits = 0;
+    root->value = 0;
+
+    bool expanded = mcts_expand(root, board, moves);
+
+    assert(expanded);
+    (void)expanded;
+}
+
+void mcts_run(struct board *board, struct ordering_info *ordering_info) {
+    assert(mcts_nodes != NULL);
+
+    uint32_t path[MCTS_PLY_MAX+1];
+
+    while (!search_stopped()) {
+        struct board board_copy = *board;
+
+        size_t len = 0;
+
+        uint32_t idx = 0;
+
+        // selection: descend through expanded nodes, giving every node on the
+        // path a virtual loss until the playout result is known
+        while (true) {
+            struct mcts_node *node = &mcts_nodes[idx];
+
+            path[len++] = idx;
+
+            __atomic_fetch_add(&node->visits, 1, __ATOMIC_RELAXED);
+            __atomic_fetch_sub(&node->value, MCTS_VALUE_ONE, __ATOMIC_RELAXED);
+
+            if (__atomic_load_n(&node->state, __ATOMIC_ACQUIRE) != MCTS_STATE_EXPANDED ||
+                node->children_cnt == 0 || len > MCTS_PLY_MAX)
+            {
+                break;
+            }
+
+            idx = mcts_select(node);
+
+            board_do_move(&board_copy, mcts_nodes[idx].move);
+        }
+
+        struct mcts_node *leaf = &mcts_nodes[idx];
+
+        // expansion: only one thread generates the children of a leaf,
+        // the others evaluate it as it is in the meantime
+        uint8_t state = MCTS_STATE_LEAF;
+
+        if (__atomic_compare_exchange_n(&leaf->state, &state, MCTS_STATE_EXPANDING, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            struct move_list moves;
+            movegen_add_moves(&moves, &board_copy);
+
+            if (!mcts_expand(leaf, &board_copy, &moves)) {
+                __atomic_store_n(&leaf->state, MCTS_STATE_LEAF, __ATOMIC_RELEASE);
+                search_stop();
+            }
+        }
+
+        // evaluation: the value is from the point of view of the side to move at the leaf
+        int value;
+
+        if (__atomic_load_n(&leaf->state, __ATOMIC_ACQUIRE) == MCTS_STATE_EXPANDED && leaf->children_cnt == 0) {
+            value = board_color_in_check(&board_copy, board_copy.color) ? -MCTS_VALUE_ONE : 0;
+        } else {
+            value = mcts_score_to_value(search_probe(&board_copy, MCTS_PROBE_DEPTH, ordering_info));
+        }
+
+        // the probe result of an interrupted search is unreliable
+        if (search_stopped()) {
+            for (size_t i = 0; i < len; ++i) {
+                __atomic_fetch_sub(&mcts_nodes[path[i]].visits, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&mcts_nodes[path[i]].value, MCTS_VALUE_ONE, __ATOMIC_RELAXED);
+            }
+
+            break;
+        }
+
+        // backpropagation: replace the virtual losses with the playout result,
+        // alternating its point of view at every ply
+        value = -value;
+
+        for (size_t i = len; i-- > 0; ) {
+            __atomic_fetch_add(&mcts_nodes[path[i]].value, value + MCTS_VALUE_ONE, __ATOMIC_RELAXED);
+
+            value = -value;
+        }
+
+        __atomic_fetch_add(&mcts_playouts, 1, __ATOMIC_RELAXED);
+    }
+}
+
+unsigned long long mcts_get_playouts(void) {
+    return __atomic_load_n(&mcts_playouts, __ATOMIC_RELAXED);
+}
+
+/**
+ * Get the most visited child of a node after skipping the `rank` most visited ones.
+ * Returns `UINT32_MAX` if there is no such child.
+ */
+static uint32_t mcts_get_child(struct mcts_node *node, size_t rank) {
+    if (__atomic_load_n(&node->state, __ATOMIC_ACQUIRE) != MCTS_STATE_EXPANDED || rank >= node->children_cnt) {
+        return UINT32_MAX;
+    }
+
+    bool skipped[MOVE_LIST_MAX] = { false };
+
+    uint32_t best = UINT32_MAX;
+
+    for (size_t r = 0; r <= rank; ++r) {
+        best = UINT32_MAX;
+
+        for (uint32_t i = 0; i < node->children_cnt; ++i) {
+            if (skipped[i]) {
+                continue;
+            }
+
+            if (best == UINT32_MAX ||
+                mcts_nodes[node->children + i].visits > mcts_nodes[node->children + best].visits)
+            {
+                best = i;
+            }
+        }
+
+        skipped[best] = true;
+    }
+
+    return node->children + best;
+}
+
+size_t mcts_get_pv(size_t rank, struct move pv[SEARCH_PV_LEN_MAX], int *score) {
+    assert(mcts_nodes != NULL);
+    assert(score != NULL);
+
+    uint32_t idx = mcts_get_child(&mcts_nodes[0], rank);
+
+    if (idx == UINT32_MAX) {
+        return 0;
+    }
+
+    struct mcts_node *node = &mcts_nodes[idx];
+
+    *score = node->visits > 0 ? mcts_value_to_score((double)node->value / node->visits) : 0;
+
+    size_t len = 0;
+
+    while (len < SEARCH_PV_LEN_MAX) {
+        pv[len++] = node->move;
+
+        idx = mcts_get_child(node, 0);
+
+        if (idx == UINT32_MAX || mcts_nodes[idx].visits == 0) {
+            break;
+        }
+
+        node = &mcts_nodes[idx];
+    }
+
+    return len;
+}
@@ -7,14 +7,39 @@
 
 #include <string.h>
 
-static void movegen_add_move_if_legal(struct move_list *moves, struct move move, struct board *board) {
-    assert(moves != NULL);
-    assert(board != NULL);
+/**
+ * Verify if the provided pseudo-legal move does not leave the king
+ * of the moving color in check, given the attack maps of the board.
+ */
+static bool movegen_is_safe(struct board *board, const struct board_attacks *attacks, struct move move) {
+    // out of check, a king move is only illegal if it goes to an attacked square
+    // (castles already take care of the king safety) and any other move if it
+    // takes a pinned piece off its line or captures en passant (which may
+    // uncover an attack along the rank of both pawns)
+    if (attacks->checkers == BB_EMPTY) {
+        if (move.piece == KING) {
+            return (move.flags & (MOVE_FLAG_KING_CASTLE | MOVE_FLAG_QUEEN_CASTLE))
+                || !(attacks->by_color[color_flip(board->color)] & bb_squares[move.to]);
+        }
+
+        if (!(attacks->pinned & bb_squares[move.from]) && !(move.flags & MOVE_FLAG_EN_PASSANT)) {
+            return true;
+        }
+    }
 
     struct board board_copy = *board;
     board_do_move(&board_copy, move);
 
-    if (!board_color_in_check(&board_copy, board->color)) {
+    return !board_color_in_check(&board_copy, board->color);
+}
+
+static void movegen_add_move_if_legal(struct move_list *moves, struct move move,
+                                      struct board *board, const struct board_attacks *attacks)
+{
+    assert(moves != NULL);
+    assert(board != NULL);
+
+    if (movegen_is_safe(board, attacks, move)) {
         assert(moves->count < MOVE_LIST_MAX);
 
         moves->list[moves->count++] = move;
@@ -25,7 +50,8 @@ static void movegen_create_moves(struct move_list *moves,
                                  enum move_flag flags,
                                  enum square from, enum square to,
                                  enum piece piece,
-                                 struct board *board)
+                                 struct board *board,
+                                 const struct board_attacks *attacks)
 {
     assert(moves != NULL);
     assert(board != NULL);
@@ -33,13 +59,15 @@ static void movegen_create_moves(struct move_list *moves,
     enum color color = board->color;
     enum color color_other = color_flip(color);
 
-    struct move move;
-
-    move.flags = flags;
-    move.from = from;
-    move.to = to;
-    move.piece = piece;
-    move.score = 0;
+    // the fields that do not apply to the move are zeroed
+    // so that whole moves can be compared and hashed
+    struct move move = {
+        .flags = flags,
+        .from = from,
+        .to = to,
+        .piece = piece,
+        .score = 0,
+    };
 
     if (bb_squares[to] & board->bb_pieces[color_other][BB_ALL]) {
         move.flags |= MOVE_FLAG_CAPTURE;
@@ -60,14 +88,16 @@ static void movegen_create_moves(struct move_list *moves,
 
             move.promotion = p;
 
-            movegen_add_move_if_legal(moves, move, board);
+            movegen_add_move_if_legal(moves, move, board, attacks);
         }
     } else {
-        movegen_add_move_if_legal(moves, move, board);
+        movegen_add_move_if_legal(moves, move, board, attacks);
     }
 }
 
-static void movegen_add_rook_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_rook_moves(struct move_list *moves, struct board *board,
+                                  const struct board_attacks *attacks, bb_t bb_targets)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -78,17 +108,19 @@ static void movegen_add_rook_moves(struct move_list *moves, struct board *board)
     while (bb_rooks) {
         enum square from = bb_pop_lsb(&bb_rooks);
 
-        bb_t bb_attacks = board_get_attacks(board, color, ROOK, from);
+        bb_t bb_attacks = attacks->by_square[from] & bb_targets;
 
         while (bb_attacks) {
             enum square to = bb_pop_lsb(&bb_attacks);
 
-            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, ROOK, board);
+            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, ROOK, board, attacks);
         }
     }
 }
 
-static void movegen_add_knight_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_knight_moves(struct move_list *moves, struct board *board,
+                                  const struct board_attacks *attacks, bb_t bb_targets)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -99,17 +131,19 @@ static void movegen_add_knight_moves(struct move_list *moves, struct board *boar
     while (bb_knights) {
         enum square from = bb_pop_lsb(&bb_knights);
 
-        bb_t bb_attacks = board_get_attacks(board, color, KNIGHT, from);
+        bb_t bb_attacks = attacks->by_square[from] & bb_targets;
 
         while (bb_attacks) {
             enum square to = bb_pop_lsb(&bb_attacks);
 
-            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, KNIGHT, board);
+            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, KNIGHT, board, attacks);
         }
     }
 }
 
-static void movegen_add_bishop_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_bishop_moves(struct move_list *moves, struct board *board,
+                                  const struct board_attacks *attacks, bb_t bb_targets)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -120,17 +154,19 @@ static void movegen_add_bishop_moves(struct move_list *moves, struct board *boar
     while (bb_bishops) {
         enum square from = bb_pop_lsb(&bb_bishops);
 
-        bb_t bb_attacks = board_get_attacks(board, color, BISHOP, from);
+        bb_t bb_attacks = attacks->by_square[from] & bb_targets;
 
         while (bb_attacks) {
             enum square to = bb_pop_lsb(&bb_attacks);
 
-            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, BISHOP, board);
+            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, BISHOP, board, attacks);
         }
     }
 }
 
-static void movegen_add_queen_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_queen_moves(struct move_list *moves, struct board *board,
+                                  const struct board_attacks *attacks, bb_t bb_targets)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -141,17 +177,17 @@ static void movegen_add_queen_moves(struct move_list *moves, struct board *board
     while (bb_queens) {
         enum square from = bb_pop_lsb(&bb_queens);
 
-        bb_t bb_attacks = board_get_attacks(board, color, QUEEN, from);
+        bb_t bb_attacks = attacks->by_square[from] & bb_targets;
 
         while (bb_attacks) {
             enum square to = bb_pop_lsb(&bb_attacks);
 
-            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, QUEEN, board);
+            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, QUEEN, board, attacks);
         }
     }
 }
 
-static void movegen_add_king_castles(struct move_list *moves, struct board *board) {
+static void movegen_add_king_castles(struct move_list *moves, struct board *board, const struct board_attacks *attacks) {
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -166,15 +202,17 @@ static void movegen_add_king_castles(struct move_list *moves, struct board *boar
     }
 
     if (board_color_castle_king(board, color)) {
-        movegen_create_moves(moves, MOVE_FLAG_KING_CASTLE, ks, ks+2, KING, board);
+        movegen_create_moves(moves, MOVE_FLAG_KING_CASTLE, ks, ks+2, KING, board, attacks);
     }
 
     if (board_color_castle_queen(board, color)) {
-        movegen_create_moves(moves, MOVE_FLAG_QUEEN_CASTLE, ks, ks-2, KING, board);
+        movegen_create_moves(moves, MOVE_FLAG_QUEEN_CASTLE, ks, ks-2, KING, board, attacks);
     }
 }
 
-static void movegen_add_king_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_king_moves(struct move_list *moves, struct board *board,
+                                   const struct board_attacks *attacks, bb_t bb_targets, enum movegen_type type)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -188,18 +226,22 @@ static void movegen_add_king_moves(struct move_list *moves, struct board *board)
         return;
     }
 
-    bb_t bb_attacks = board_get_attacks(board, color, KING, from);
+    bb_t bb_attacks = attacks->by_square[from] & bb_targets;
 
     while (bb_attacks) {
         enum square to = bb_pop_lsb(&bb_attacks);
 
-        movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, KING, board);
+        movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, KING, board, attacks);
     }
 
-    movegen_add_king_castles(moves, board);
+    if (type != MOVEGEN_CAPTURES) {
+        movegen_add_king_castles(moves, board, attacks);
+    }
 }
 
-static void movegen_add_pawn_pushes(struct move_list *moves, struct board *board) {
+static void movegen_add_pawn_pushes(struct move_list *moves, struct board *board,
+                                    const struct board_attacks *attacks, enum movegen_type type)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -217,22 +259,31 @@ static void movegen_add_pawn_pushes(struct move_list *moves, struct board *board
 
     bb_pushes &= ~bb_promotions;
 
+    // promotions are generated together with captures
+    if (type == MOVEGEN_CAPTURES) {
+        bb_pushes = BB_EMPTY;
+    }
+
     while (bb_pushes) {
         enum square to = bb_pop_lsb(&bb_pushes);
         enum square from = to+(color == WHITE ? -FL_CNT : +FL_CNT);
 
-        movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, PAWN, board);
+        movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, PAWN, board, attacks);
+    }
+
+    if (type == MOVEGEN_QUIETS) {
+        return;
     }
 
     while (bb_promotions) {
         enum square to = bb_pop_lsb(&bb_promotions);
         enum square from = to+(color == WHITE ? -FL_CNT : +FL_CNT);
 
-        movegen_create_moves(moves, MOVE_FLAG_PROMOTION, from, to, PAWN, board);
+        movegen_create_moves(moves, MOVE_FLAG_PROMOTION, from, to, PAWN, board, attacks);
     }
 }
 
-static void movegen_add_pawn_double_pushes(struct move_list *moves, struct board *board) {
+static void movegen_add_pawn_double_pushes(struct move_list *moves, struct board *board, const struct board_attacks *attacks) {
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -253,11 +304,11 @@ static void movegen_add_pawn_double_pushes(struct move_list *moves, struct board
         enum square to = bb_pop_lsb(&bb_double_pushes);
         enum square from = to+(color == WHITE ? -2*FL_CNT : +2*FL_CNT);
 
-        movegen_create_moves(moves, MOVE_FLAG_PAWN_DOUBLE_PUSH, from, to, PAWN, board);
+        movegen_create_moves(moves, MOVE_FLAG_PAWN_DOUBLE_PUSH, from, to, PAWN, board, attacks);
     }
 }
 
-static void movegen_add_pawn_attacks(struct move_list *moves, struct board *board) {
+static void movegen_add_pawn_attacks(struct move_list *moves, struct board *board, const struct board_attacks *attacks) {
     assert(moves != NULL);
     assert(board != NULL);
 
@@ -269,7 +320,7 @@ static void movegen_add_pawn_attacks(struct move_list *moves, struct board *boar
     while (bb_pawns) {
         enum square from = bb_pop_lsb(&bb_pawns);
 
-        bb_t bb_attacks = board_get_attacks(board, color, PAWN, from);
+        bb_t bb_attacks = attacks->by_square[from];
 
         bb_attacks &= board->bb_pieces[color_other][BB_ALL];
 
@@ -280,13 +331,13 @@ static void movegen_add_pawn_attacks(struct move_list *moves, struct board *boar
         while (bb_attacks) {
             enum square to = bb_pop_lsb(&bb_attacks);
 
-            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, PAWN, board);
+            movegen_create_moves(moves, MOVE_FLAG_NONE, from, to, PAWN, board, attacks);
         }
 
         while (bb_promotions) {
             enum square to = bb_pop_lsb(&bb_promotions);
 
-            movegen_create_moves(moves, MOVE_FLAG_PROMOTION, from, to, PAWN, board);
+            movegen_create_moves(moves, MOVE_FLAG_PROMOTION, from, to, PAWN, board, attacks);
         }
     }
 
@@ -302,7 +353,7 @@ static void movegen_add_pawn_attacks(struct move_list *moves, struct board *boar
         bb_en_passant_left &= ~bb_files[FL_H];
 
         if (bb_en_passant_left) {
-            movegen_create_moves(moves, MOVE_FLAG_EN_PASSANT, from, to, PAWN, board);
+            movegen_create_moves(moves, MOVE_FLAG_EN_PASSANT, from, to, PAWN, board, attacks);
         }
 
         from = to+(color == WHITE ? -(FL_CNT-1) : +(FL_CNT+1));
@@ -312,30 +363,180 @@ static void movegen_add_pawn_attacks(struct move_list *moves, struct board *boar
         bb_en_passant_right &= ~bb_files[FL_A];
 
         if (bb_en_passant_right) {
-            movegen_create_moves(moves, MOVE_FLAG_EN_PASSANT, from, to, PAWN, board);
+            movegen_create_moves(moves, MOVE_FLAG_EN_PASSANT, from, to, PAWN, board, attacks);
         }
     }
 }
 
-static void movegen_add_pawn_moves(struct move_list *moves, struct board *board) {
+static void movegen_add_pawn_moves(struct move_list *moves, struct board *board,
+                                   const struct board_attacks *attacks, enum movegen_type type)
+{
     assert(moves != NULL);
     assert(board != NULL);
 
-    movegen_add_pawn_pushes(moves, board);
-    movegen_add_pawn_double_pushes(moves, board);
-    movegen_add_pawn_attacks(moves, board);
+    movegen_add_pawn_pushes(moves, board, attacks, type);
+
+    if (type != MOVEGEN_CAPTURES) {
+        movegen_add_pawn_double_pushes(moves, board, attacks);
+    }
+
+    if (type != MOVEGEN_QUIETS) {
+        movegen_add_pawn_attacks(moves, board, attacks);
+    }
 }
 
-void movegen_add_moves(struct move_list *moves, struct board *board) {
+/**
+ * Populate the provided move list with the moves of the requested type.
+ */
+static void movegen_add_typed_moves(struct move_list *moves, struct board *board, enum movegen_type type) {
     assert(moves != NULL);
     assert(board != NULL);
 
+    enum color color = board->color;
+    enum color color_other = color_flip(color);
+
+    bb_t bb_targets;
+
+    switch (type) {
+    case MOVEGEN_CAPTURES:
+        bb_targets = board->bb_pieces[color_other][BB_ALL];
+        break;
+
+    case MOVEGEN_QUIETS:
+        bb_targets = ~(board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_other][BB_ALL]);
+        break;
+
+    default:
+        bb_targets = ~board->bb_pieces[color][BB_ALL];
+        break;
+    }
+
     moves->count = 0;
 
-    movegen_add_rook_moves(moves, board);
-    movegen_add_knight_moves(moves, board);
-    movegen_add_bishop_moves(moves, board);
-    movegen_add_queen_moves(moves, board);
-    movegen_add_king_moves(moves, board);
-    movegen_add_pawn_moves(moves, board);
+    const struct board_attacks *attacks = board_get_attack_maps(board);
+
+    movegen_add_rook_moves(moves, board, attacks, bb_targets);
+    movegen_add_knight_moves(moves, board, attacks, bb_targets);
+    movegen_add_bishop_moves(moves, board, attacks, bb_targets);
+    movegen_add_queen_moves(moves, board, attacks, bb_targets);
+    movegen_add_king_moves(moves, board, attacks, bb_targets, type);
+    movegen_add_pawn_moves(moves, board, attacks, type);
+}
+
+void movegen_add_moves(struct move_list *moves, struct board *board) {
+    movegen_add_typed_moves(moves, board, MOVEGEN_ALL);
+}
+
+void movegen_add_captures(struct move_list *moves, struct board *board) {
+    movegen_add_typed_moves(moves, board, MOVEGEN_CAPTURES);
+}
+
+void movegen_add_quiets(struct move_list *moves, struct board *board) {
+    movegen_add_typed_moves(moves, board, MOVEGEN_QUIETS);
+}
+
+bool movegen_is_legal(struct board *board, struct move move) {
+    assert(board != NULL);
+
+    if (move.flags & MOVE_FLAG_NULL || move.flags == MOVE_FLAG_INVALID) {
+        return false;
+    }
+
+    enum color color = board->color;
+    enum color color_other = color_flip(color);
+
+    if (move.piece >= PIECE_CNT || !(board->bb_pieces[color][move.piece] & bb_squares[move.from])) {
+        return false;
+    }
+
+    if (board->bb_pieces[color][BB_ALL] & bb_squares[move.to]) {
+        return false;
+    }
+
+    bool capture = board->bb_pieces[color_other][BB_ALL] & bb_squares[move.to];
+
+    const struct board_attacks *attacks = board_get_attack_maps(board);
+
+    if (capture != !!(move.flags & MOVE_FLAG_CAPTURE)) {
+        return false;
+    }
+
+    if (capture && (move.capture >= PIECE_CNT || !(board->bb_pieces[color_other][move.capture] & bb_squares[move.to]))) {
+        return false;
+    }
+
+    if (move.flags & (MOVE_FLAG_KING_CASTLE | MOVE_FLAG_QUEEN_CASTLE)) {
+        if (move.piece != KING || capture) {
+            return false;
+        }
+
+        // the castle checks already take care of the king safety
+        if (move.flags == MOVE_FLAG_KING_CASTLE) {
+            return move.to == move.from+2 && board_color_castle_king(board, color);
+        }
+
+        if (move.flags == MOVE_FLAG_QUEEN_CASTLE) {
+            return move.to == move.from-2 && board_color_castle_queen(board, color);
+        }
+
+        return false;
+    }
+
+    if (move.piece == PAWN) {
+        int push = color == WHITE ? +FL_CNT : -FL_CNT;
+
+        bb_t bb_occ = board->bb_pieces[color][BB_ALL] | board->bb_pieces[color_other][BB_ALL];
+
+        bool last_rank = bb_squares[move.to] & bb_ranks[color == WHITE ? RK_8 : RK_1];
+
+        if (last_rank != !!(move.flags & MOVE_FLAG_PROMOTION)) {
+            return false;
+        }
+
+        if (last_rank && (move.promotion == KING || move.promotion >= PAWN)) {
+            return false;
+        }
+
+        if (move.flags & MOVE_FLAG_EN_PASSANT) {
+            if (move.flags != MOVE_FLAG_EN_PASSANT || move.to != board->en_passant) {
+                return false;
+            }
+
+            if (!(attacks->by_square[move.from] & bb_squares[move.to])) {
+                return false;
+            }
+        } else if (capture) {
+            if (move.flags & MOVE_FLAG_PAWN_DOUBLE_PUSH) {
+                return false;
+            }
+
+            if (!(attacks->by_square[move.from] & bb_squares[move.to])) {
+                return false;
+            }
+        } else if (move.flags & MOVE_FLAG_PAWN_DOUBLE_PUSH) {
+            if (move.flags != MOVE_FLAG_PAWN_DOUBLE_PUSH || (int)move.to != (int)move.from+2*push) {
+                return false;
+            }
+
+            if (!(bb_squares[move.from] & bb_ranks[color == WHITE ? RK_2 : RK_7])) {
+                return false;
+            }
+
+            if (bb_occ & bb_squares[move.from+push]) {
+                return false;
+            }
+        } else if ((int)move.to != (int)move.from+push) {
+            return false;
+        }
+    } else {
+        if (move.flags & ~MOVE_FLAG_CAPTURE) {
+            return false;
+        }
+
+        if (!(attacks->by_square[move.from] & bb_squares[move.to])) {
+            return false;
+        }
+    }
+
+    return movegen_is_safe(board, attacks, move);
 }
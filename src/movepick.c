@@ -0,0 +1,276 @@
+#include "movepick.h"
+
+#include "board.h"
+#include "eval.h"
+#include "move.h"
+#include "movegen.h"
+#include "search.h"
+
+#include <assert.h>
+#include <limits.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Move ordering:
+ * https://www.chessprogramming.org/Move_Ordering
+ *
+ * Staged move generation:
+ * https://www.chessprogramming.org/Move_Generation#Staged_move_generation
+ *
+ */
+
+static const struct move MOVE_NONE = { .flags = MOVE_FLAG_INVALID };
+
+void mp_init(struct move_picker *mp, struct board *board,
+             struct ordering_info *ordering_info,
+             const struct search_stack *ss, struct move hash_move)
+{
+    assert(mp != NULL);
+    assert(board != NULL);
+
+    mp->board = board;
+    mp->ordering_info = ordering_info;
+
+    mp->stage = MP_STAGE_HASH;
+    mp->captures_only = false;
+    mp->skip_quiets = false;
+
+    mp->hash_move = movegen_is_legal(board, hash_move) ? hash_move : MOVE_NONE;
+
+    mp->refutation_idx = 0;
+
+    for (size_t i = 0; i < MP_REFUTATION_CNT; i++) {
+        mp->refutations[i] = MOVE_NONE;
+    }
+
+    if (ordering_info != NULL) {
+        assert(ss != NULL);
+
+        struct move previous = (ss-1)->current;
+
+        mp->refutations[0] = ss->killers[0];
+        mp->refutations[1] = ss->killers[1];
+
+        if (previous.flags != MOVE_FLAG_INVALID) {
+            mp->refutations[2] = ordering_info->counter[color_flip(board->color)][previous.piece][previous.to];
+        }
+    }
+}
+
+void mp_init_captures(struct move_picker *mp, struct board *board) {
+    mp_init(mp, board, NULL, NULL, MOVE_NONE);
+
+    mp->stage = MP_STAGE_CAPTURES_INIT;
+    mp->captures_only = true;
+}
+
+/**
+ * Remove and return the best scored move from the moves
+ * that have not been picked yet (selection sort step).
+ */
+static struct move mp_select_best(struct move_list *moves) {
+    size_t best_index = moves->head;
+
+    for (size_t i = moves->head+1; i < moves->count; i++) {
+        if (moves->list[i].score > moves->list[best_index].score) {
+            best_index = i;
+        }
+    }
+
+    struct move aux = moves->list[moves->head];
+    moves->list[moves->head] = moves->list[best_index];
+    moves->list[best_index] = aux;
+
+    return moves->list[moves->head++];
+}
+
+static void mp_score_captures(struct move_picker *mp) {
+    struct move_list *moves = &mp->captures;
+
+    for (size_t i = 0; i < moves->count; i++) {
+        struct move move = moves->list[i];
+
+        if (move.flags & MOVE_FLAG_CAPTURE) {
+            moves->list[i].score = CAPTURE_BONUS + other_attacks_table[move.capture][move.piece];
+        } else if (move.flags & MOVE_FLAG_PROMOTION) {
+            moves->list[i].score = PROMOTION_BONUS + get_piece_value(move.promotion);
+        } else { // en passant
+            moves->list[i].score = CAPTURE_BONUS + other_attacks_table[PAWN][PAWN];
+        }
+    }
+}
+
+static void mp_score_quiets(struct move_picker *mp) {
+    struct move_list *moves = &mp->quiets;
+    struct ordering_info *ordering_info = mp->ordering_info;
+
+    for (size_t i = 0; i < moves->count; i++) {
+        struct move move = moves->list[i];
+
+        moves->list[i].score = ordering_info != NULL
+                             ? QUIET_BONUS + ordering_info->history[mp->board->color][move.from][move.to]
+                             : QUIET_BONUS;
+    }
+}
+
+/**
+ * Verify if the move was already picked in an earlier stage.
+ */
+static bool mp_already_picked(struct move_picker *mp, struct move move) {
+    if (move_equal(move, mp->hash_move)) {
+        return true;
+    }
+
+    if (mp->stage > MP_STAGE_REFUTATIONS) {
+        for (size_t i = 0; i < MP_REFUTATION_CNT; i++) {
+            if (move_equal(move, mp->refutations[i])) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Verify if a capture does not lose material. Captures of a piece at least
+ * as valuable as the capturing piece cannot lose material, so the static
+ * exchange evaluation is only needed for the other captures.
+ */
+static bool mp_good_capture(struct move_picker *mp, struct move move) {
+    if (!(move.flags & MOVE_FLAG_CAPTURE) || move.piece == KING) {
+        return true;
+    }
+
+    if (get_piece_value(move.capture) >= get_piece_value(move.piece)) {
+        return true;
+    }
+
+    return static_exchange_evaluation(mp->board, move) >= 0;
+}
+
+void mp_skip_quiets(struct move_picker *mp) {
+    assert(mp != NULL);
+
+    mp->skip_quiets = true;
+}
+
+struct move mp_next(struct move_picker *mp) {
+    assert(mp != NULL);
+
+    while (true) {
+        if (mp->skip_quiets && mp->stage >= MP_STAGE_REFUTATIONS && mp->stage <= MP_STAGE_QUIETS) {
+            mp->captures.head = 0;
+
+            mp->stage = MP_STAGE_BAD_CAPTURES;
+        }
+
+        switch (mp->stage) {
+        case MP_STAGE_HASH:
+            mp->stage++;
+
+            if (mp->hash_move.flags != MOVE_FLAG_INVALID) {
+                return mp->hash_move;
+            }
+
+            break;
+
+        case MP_STAGE_CAPTURES_INIT:
+            movegen_add_captures(&mp->captures, mp->board);
+            mp_score_captures(mp);
+
+            mp->captures.head = 0;
+            mp->bad_captures_cnt = 0;
+
+            mp->stage++;
+            break;
+
+        case MP_STAGE_GOOD_CAPTURES:
+            while (mp->captures.head < mp->captures.count) {
+                struct move move = mp_select_best(&mp->captures);
+
+                if (mp_already_picked(mp, move)) {
+                    continue;
+                }
+
+                if (!mp_good_capture(mp, move)) {
+                    // the picked slots are free to hold the bad captures
+                    mp->captures.list[mp->bad_captures_cnt++] = move;
+                    continue;
+                }
+
+                return move;
+            }
+
+            mp->stage = mp->captures_only ? MP_STAGE_DONE : MP_STAGE_REFUTATIONS;
+            break;
+
+        case MP_STAGE_REFUTATIONS:
+            while (mp->refutation_idx < MP_REFUTATION_CNT) {
+                struct move move = mp->refutations[mp->refutation_idx++];
+
+                if (move.flags & (MOVE_FLAG_CAPTURE | MOVE_FLAG_PROMOTION | MOVE_FLAG_EN_PASSANT)) {
+                    continue;
+                }
+
+                if (mp_already_picked(mp, move)) {
+                    continue;
+                }
+
+                // the counter move may be one of the killers
+                bool duplicate = false;
+
+                for (size_t i = 0; i+1 < mp->refutation_idx; i++) {
+                    duplicate |= move_equal(move, mp->refutations[i]);
+                }
+
+                if (duplicate || !movegen_is_legal(mp->board, move)) {
+                    continue;
+                }
+
+                return move;
+            }
+
+            mp->stage++;
+            break;
+
+        case MP_STAGE_QUIETS_INIT:
+            movegen_add_quiets(&mp->quiets, mp->board);
+            mp_score_quiets(mp);
+
+            mp->quiets.head = 0;
+
+            mp->stage++;
+            break;
+
+        case MP_STAGE_QUIETS:
+            while (mp->quiets.head < mp->quiets.count) {
+                struct move move = mp_select_best(&mp->quiets);
+
+                if (mp_already_picked(mp, move)) {
+                    continue;
+                }
+
+                return move;
+            }
+
+            mp->captures.head = 0;
+
+            mp->stage++;
+            break;
+
+        case MP_STAGE_BAD_CAPTURES:
+            if (mp->captures.head < mp->bad_captures_cnt) {
+                return mp->captures.list[mp->captures.head++];
+            }
+
+            mp->stage++;
+            break;
+
+        default:
+            return MOVE_NONE;
+        }
+    }
+}
@@ -0,0 +1,592 @@
+#include "nnue.h"
+
+#include "bitboard.h"
+#include "board.h"
+#include "zobrist.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * NNUE:
+ * https://www.chessprogramming.org/NNUE
+ * Yu Nasu, "Efficiently Updatable Neural-Network-based Evaluation Functions
+ * for Computer Shogi" (2018)
+ *
+ * HalfKP:
+ * https://www.chessprogramming.org/Stockfish_NNUE#HalfKP
+ *
+ */
+
+/**
+ * Number of bits by which the sums of the hidden layers are shifted
+ * (the weights are quantized with 64 as 1.0).
+ */
+#define NNUE_WEIGHT_SHIFT 6
+
+/**
+ * Divisor converting the output of the network to centipawns.
+ */
+#define NNUE_OUTPUT_SCALE 16
+
+/**
+ * Maximum value of the (clipped) activations.
+ */
+#define NNUE_ACTIVATION_MAX 127
+
+/**
+ * Parameters of the network.
+ */
+struct nnue_network {
+    int16_t ft_biases[NNUE_HALF_DIMS];
+    int16_t ft_weights[NNUE_INPUTS][NNUE_HALF_DIMS];
+
+    int32_t hidden1_biases[NNUE_HIDDEN1_DIMS];
+    int8_t hidden1_weights[NNUE_HIDDEN1_DIMS][2*NNUE_HALF_DIMS];
+
+    int32_t hidden2_biases[NNUE_HIDDEN2_DIMS];
+    int8_t hidden2_weights[NNUE_HIDDEN2_DIMS][NNUE_HIDDEN1_DIMS];
+
+    int32_t output_bias;
+    int8_t output_weights[NNUE_HIDDEN2_DIMS];
+};
+
+/**
+ * Inference kernels (implemented once per supported SIMD instruction set).
+ */
+struct nnue_kernels {
+    const char *name;
+
+    // add (or subtract) a feature transformer column to an accumulator
+    void (*add)(int16_t *values, const int16_t *weights);
+    void (*sub)(int16_t *values, const int16_t *weights);
+
+    // clip the accumulators of both perspectives into the inputs of the first hidden layer
+    void (*transform)(const int16_t *first, const int16_t *second, uint8_t *out);
+
+    // compute the biased sums of a layer (`in_cnt` must be a multiple of 32)
+    void (*affine)(const uint8_t *in, size_t in_cnt, const int8_t *weights,
+                   const int32_t *biases, size_t out_cnt, int32_t *out);
+};
+
+static struct nnue_network *nnue_network = NULL;
+static unsigned nnue_network_cnt = 0; // number of networks loaded so far (accumulators of older ones are stale)
+
+static const struct nnue_kernels *nnue_kernels = NULL;
+
+static __thread struct nnue_accumulator *nnue_table = NULL; // accumulator table of the current thread
+
+/**
+ * Index of the non-king pieces in the features.
+ */
+static const int nnue_piece_idxs[PIECE_CNT] = {
+    [PAWN]   = 0,
+    [KNIGHT] = 1,
+    [BISHOP] = 2,
+    [ROOK]   = 3,
+    [QUEEN]  = 4,
+    [KING]   = -1,
+};
+
+/*******************
+ * GENERIC KERNELS *
+ *******************/
+
+static void nnue_add_generic(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; ++i) {
+        values[i] += weights[i];
+    }
+}
+
+static void nnue_sub_generic(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; ++i) {
+        values[i] -= weights[i];
+    }
+}
+
+static void nnue_transform_generic(const int16_t *first, const int16_t *second, uint8_t *out) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; ++i) {
+        out[i] = first[i] < 0 ? 0 : first[i] > NNUE_ACTIVATION_MAX ? NNUE_ACTIVATION_MAX : first[i];
+        out[NNUE_HALF_DIMS + i] = second[i] < 0 ? 0 : second[i] > NNUE_ACTIVATION_MAX ? NNUE_ACTIVATION_MAX : second[i];
+    }
+}
+
+static void nnue_affine_generic(const uint8_t *in, size_t in_cnt, const int8_t *weights,
+                                const int32_t *biases, size_t out_cnt, int32_t *out)
+{
+    for (size_t o = 0; o < out_cnt; ++o) {
+        int32_t sum = biases[o];
+
+        for (size_t i = 0; i < in_cnt; ++i) {
+            sum += in[i] * weights[o*in_cnt + i];
+        }
+
+        out[o] = sum;
+    }
+}
+
+static const struct nnue_kernels nnue_kernels_generic = {
+    .name = "none",
+    .add = nnue_add_generic,
+    .sub = nnue_sub_generic,
+    .transform = nnue_transform_generic,
+    .affine = nnue_affine_generic,
+};
+
+#ifdef NNUE_X86
+
+/****************
+ * SSE2 KERNELS *
+ ****************/
+
+__attribute__((target("sse2")))
+static void nnue_add_sse2(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&values[i]);
+        __m128i w = _mm_loadu_si128((const __m128i *)&weights[i]);
+
+        _mm_storeu_si128((__m128i *)&values[i], _mm_add_epi16(v, w));
+    }
+}
+
+__attribute__((target("sse2")))
+static void nnue_sub_sse2(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&values[i]);
+        __m128i w = _mm_loadu_si128((const __m128i *)&weights[i]);
+
+        _mm_storeu_si128((__m128i *)&values[i], _mm_sub_epi16(v, w));
+    }
+}
+
+__attribute__((target("sse2")))
+static void nnue_transform_sse2(const int16_t *first, const int16_t *second, uint8_t *out) {
+    const int16_t *halves[COLOR_CNT] = { first, second };
+
+    __m128i zero = _mm_setzero_si128();
+
+    for (size_t h = 0; h < COLOR_CNT; ++h) {
+        for (size_t i = 0; i < NNUE_HALF_DIMS; i += 16) {
+            __m128i lo = _mm_max_epi16(_mm_loadu_si128((const __m128i *)&halves[h][i]), zero);
+            __m128i hi = _mm_max_epi16(_mm_loadu_si128((const __m128i *)&halves[h][i + 8]), zero);
+
+            // saturating to 127 completes the clipping
+            _mm_storeu_si128((__m128i *)&out[h*NNUE_HALF_DIMS + i], _mm_packs_epi16(lo, hi));
+        }
+    }
+}
+
+__attribute__((target("sse2")))
+static void nnue_affine_sse2(const uint8_t *in, size_t in_cnt, const int8_t *weights,
+                             const int32_t *biases, size_t out_cnt, int32_t *out)
+{
+    __m128i zero = _mm_setzero_si128();
+
+    for (size_t o = 0; o < out_cnt; ++o) {
+        const int8_t *row = &weights[o*in_cnt];
+
+        __m128i sums = zero;
+
+        for (size_t i = 0; i < in_cnt; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i *)&in[i]);
+            __m128i w = _mm_loadu_si128((const __m128i *)&row[i]);
+
+            // widen to 16 bits (inputs are unsigned, weights signed)
+            __m128i x_lo = _mm_unpacklo_epi8(x, zero);
+            __m128i x_hi = _mm_unpackhi_epi8(x, zero);
+            __m128i w_lo = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+            __m128i w_hi = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+
+            sums = _mm_add_epi32(sums, _mm_madd_epi16(x_lo, w_lo));
+            sums = _mm_add_epi32(sums, _mm_madd_epi16(x_hi, w_hi));
+        }
+
+        sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        out[o] = biases[o] + _mm_cvtsi128_si32(sums);
+    }
+}
+
+static const struct nnue_kernels nnue_kernels_sse2 = {
+    .name = "sse2",
+    .add = nnue_add_sse2,
+    .sub = nnue_sub_sse2,
+    .transform = nnue_transform_sse2,
+    .affine = nnue_affine_sse2,
+};
+
+/****************
+ * AVX2 KERNELS *
+ ****************/
+
+__attribute__((target("avx2")))
+static void nnue_add_avx2(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&values[i]);
+        __m256i w = _mm256_loadu_si256((const __m256i *)&weights[i]);
+
+        _mm256_storeu_si256((__m256i *)&values[i], _mm256_add_epi16(v, w));
+    }
+}
+
+__attribute__((target("avx2")))
+static void nnue_sub_avx2(int16_t *values, const int16_t *weights) {
+    for (size_t i = 0; i < NNUE_HALF_DIMS; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&values[i]);
+        __m256i w = _mm256_loadu_si256((const __m256i *)&weights[i]);
+
+        _mm256_storeu_si256((__m256i *)&values[i], _mm256_sub_epi16(v, w));
+    }
+}
+
+__attribute__((target("avx2")))
+static void nnue_transform_avx2(const int16_t *first, const int16_t *second, uint8_t *out) {
+    const int16_t *halves[COLOR_CNT] = { first, second };
+
+    __m256i zero = _mm256_setzero_si256();
+
+    for (size_t h = 0; h < COLOR_CNT; ++h) {
+        for (size_t i = 0; i < NNUE_HALF_DIMS; i += 32) {
+            __m256i lo = _mm256_max_epi16(_mm256_loadu_si256((const __m256i *)&halves[h][i]), zero);
+            __m256i hi = _mm256_max_epi16(_mm256_loadu_si256((const __m256i *)&halves[h][i + 16]), zero);
+
+            // packing works within 128-bit lanes, so the
+            // 64-bit quarters are put back in order after it
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+
+            _mm256_storeu_si256((__m256i *)&out[h*NNUE_HALF_DIMS + i], packed);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void nnue_affine_avx2(const uint8_t *in, size_t in_cnt, const int8_t *weights,
+                             const int32_t *biases, size_t out_cnt, int32_t *out)
+{
+    __m256i ones = _mm256_set1_epi16(1);
+
+    for (size_t o = 0; o < out_cnt; ++o) {
+        const int8_t *row = &weights[o*in_cnt];
+
+        __m256i sums = _mm256_setzero_si256();
+
+        for (size_t i = 0; i < in_cnt; i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)&in[i]);
+            __m256i w = _mm256_loadu_si256((const __m256i *)&row[i]);
+
+            // pairs of products cannot saturate, since inputs are at most 127
+            __m256i products = _mm256_maddubs_epi16(x, w);
+
+            sums = _mm256_add_epi32(sums, _mm256_madd_epi16(products, ones));
+        }
+
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        out[o] = biases[o] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+static const struct nnue_kernels nnue_kernels_avx2 = {
+    .name = "avx2",
+    .add = nnue_add_avx2,
+    .sub = nnue_sub_avx2,
+    .transform = nnue_transform_avx2,
+    .affine = nnue_affine_avx2,
+};
+
+#endif // NNUE_X86
+
+void nnue_init(void) {
+    nnue_kernels = &nnue_kernels_generic;
+
+#ifdef NNUE_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx2")) {
+        nnue_kernels = &nnue_kernels_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        nnue_kernels = &nnue_kernels_sse2;
+    }
+#endif
+}
+
+void nnue_term(void) {
+    free(nnue_network);
+    nnue_network = NULL;
+}
+
+/**
+ * Read `cnt` little-endian integers of `size` bytes from a file.
+ * Returns `false` if the file ends before.
+ */
+static bool nnue_read(FILE *file, void *values, size_t size, size_t cnt) {
+    if (fread(values, size, cnt, file) != cnt) {
+        return false;
+    }
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for (size_t i = 0; i < cnt; ++i) {
+        if (size == sizeof(int16_t)) {
+            ((uint16_t *)values)[i] = __builtin_bswap16(((uint16_t *)values)[i]);
+        } else if (size == sizeof(int32_t)) {
+            ((uint32_t *)values)[i] = __builtin_bswap32(((uint32_t *)values)[i]);
+        }
+    }
+#endif
+
+    return true;
+}
+
+bool nnue_load(const char *path) {
+    assert(path != NULL);
+
+    nnue_term();
+
+    if (*path == '\0') {
+        return true;
+    }
+
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    struct nnue_network *network = malloc(sizeof(*network));
+
+    if (network == NULL) {
+        fclose(file);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t header[5];
+
+    const uint32_t header_expected[5] = {
+        NNUE_VERSION, NNUE_INPUTS, NNUE_HALF_DIMS, NNUE_HIDDEN1_DIMS, NNUE_HIDDEN2_DIMS,
+    };
+
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, "HCNN", sizeof(magic)) == 0
+           && nnue_read(file, header, sizeof(*header), 5) && memcmp(header, header_expected, sizeof(header)) == 0
+           && nnue_read(file, network->ft_biases, sizeof(int16_t), NNUE_HALF_DIMS)
+           && nnue_read(file, network->ft_weights, sizeof(int16_t), NNUE_INPUTS*NNUE_HALF_DIMS)
+           && nnue_read(file, network->hidden1_biases, sizeof(int32_t), NNUE_HIDDEN1_DIMS)
+           && nnue_read(file, network->hidden1_weights, sizeof(int8_t), NNUE_HIDDEN1_DIMS*2*NNUE_HALF_DIMS)
+           && nnue_read(file, network->hidden2_biases, sizeof(int32_t), NNUE_HIDDEN2_DIMS)
+           && nnue_read(file, network->hidden2_weights, sizeof(int8_t), NNUE_HIDDEN2_DIMS*NNUE_HIDDEN1_DIMS)
+           && nnue_read(file, &network->output_bias, sizeof(int32_t), 1)
+           && nnue_read(file, network->output_weights, sizeof(int8_t), NNUE_HIDDEN2_DIMS)
+           && fgetc(file) == EOF; // trailing data means another format
+
+    fclose(file);
+
+    if (!ok) {
+        free(network);
+        return false;
+    }
+
+    nnue_network = network;
+    nnue_network_cnt++;
+
+    return true;
+}
+
+bool nnue_is_loaded(void) {
+    return nnue_network != NULL;
+}
+
+const char * nnue_get_simd(void) {
+    assert(nnue_kernels != NULL);
+
+    return nnue_kernels->name;
+}
+
+void nnue_set_table(struct nnue_accumulator *table) {
+    nnue_table = table;
+}
+
+/**
+ * Get the weights of the feature of a piece from the point of view of
+ * `perspective` with its king on `king_sq` (already seen from the perspective).
+ */
+static inline const int16_t * nnue_get_weights(enum color perspective, enum square king_sq,
+                                               enum color c, enum piece p, enum square s)
+{
+    assert(p != KING);
+
+    if (perspective == BLACK) {
+        s ^= SQ_A8; // flip vertically
+    }
+
+    size_t feature = (king_sq*10 + 2*nnue_piece_idxs[p] + (c != perspective))*SQ_CNT + s;
+
+    return nnue_network->ft_weights[feature];
+}
+
+/**
+ * Get the square of the king of the given perspective as seen from it.
+ */
+static inline enum square nnue_get_king_sq(struct board *board, enum color perspective) {
+    enum square king_sq = bb_scan_lsb(board->bb_pieces[perspective][BB_KING]);
+
+    return perspective == WHITE ? king_sq : king_sq ^ SQ_A8;
+}
+
+/**
+ * Compute the accumulator of one perspective from all the pieces on the board.
+ */
+static void nnue_refresh(struct board *board, enum color perspective, int16_t *values) {
+    enum square king_sq = nnue_get_king_sq(board, perspective);
+
+    memcpy(values, nnue_network->ft_biases, sizeof(nnue_network->ft_biases));
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            if (p == KING) {
+                continue;
+            }
+
+            bb_t bb = board->bb_pieces[c][p];
+
+            while (bb) {
+                enum square s = bb_pop_lsb(&bb);
+
+                nnue_kernels->add(values, nnue_get_weights(perspective, king_sq, c, p, s));
+            }
+        }
+    }
+}
+
+/**
+ * Update the accumulator of one perspective from the one of the position
+ * before the last move with the piece changes made by the move.
+ */
+static void nnue_update(struct board *board, enum color perspective, int16_t *values) {
+    enum square king_sq = nnue_get_king_sq(board, perspective);
+
+    for (size_t i = 0; i < board->change_cnt; ++i) {
+        const struct board_change *change = &board->changes[i];
+
+        // the kings are not features (moving the own one changes all of them)
+        if (change->piece == KING) {
+            assert(change->color != perspective);
+            continue;
+        }
+
+        if (change->from != SQ_NONE) {
+            nnue_kernels->sub(values, nnue_get_weights(perspective, king_sq, change->color, change->piece, change->from));
+        }
+
+        if (change->to != SQ_NONE) {
+            nnue_kernels->add(values, nnue_get_weights(perspective, king_sq, change->color, change->piece, change->to));
+        }
+    }
+}
+
+/**
+ * Get the accumulator of a board, from the table of the current thread
+ * if possible (`scratch` is used otherwise).
+ */
+static const struct nnue_accumulator * nnue_get_accumulator(struct board *board, struct nnue_accumulator *scratch) {
+    if (nnue_table == NULL) {
+        for (enum color perspective = 0; perspective < COLOR_CNT; ++perspective) {
+            nnue_refresh(board, perspective, scratch->values[perspective]);
+        }
+
+        return scratch;
+    }
+
+    struct nnue_accumulator *acc = &nnue_table[board->key & (NNUE_TABLE_CNT-1)];
+
+    if (acc->key == board->key && acc->key != ZB_KEY_EMPTY && acc->network == nnue_network_cnt) {
+        return acc;
+    }
+
+    // the accumulator of the position before the move may have been
+    // replaced since (or never computed), in which case it is recomputed
+    const struct nnue_accumulator *prev = &nnue_table[board->prev_key & (NNUE_TABLE_CNT-1)];
+
+    bool incremental = board->prev_key != ZB_KEY_EMPTY && prev->key == board->prev_key
+                    && prev->network == nnue_network_cnt;
+
+    for (enum color perspective = 0; perspective < COLOR_CNT; ++perspective) {
+        bool king_moved = false;
+
+        for (size_t i = 0; i < board->change_cnt; ++i) {
+            king_moved |= board->changes[i].color == (int8_t)perspective && board->changes[i].piece == KING;
+        }
+
+        if (!incremental || king_moved) {
+            nnue_refresh(board, perspective, acc->values[perspective]);
+            continue;
+        }
+
+        if (prev != acc) {
+            memcpy(acc->values[perspective], prev->values[perspective], sizeof(acc->values[perspective]));
+        }
+
+        nnue_update(board, perspective, acc->values[perspective]);
+    }
+
+    acc->key = board->key;
+    acc->network = nnue_network_cnt;
+
+    return acc;
+}
+
+/**
+ * Clip the biased sums of a hidden layer into the inputs of the next one.
+ */
+static void nnue_activate(const int32_t *sums, size_t cnt, uint8_t *out) {
+    for (size_t i = 0; i < cnt; ++i) {
+        int32_t value = sums[i] >> NNUE_WEIGHT_SHIFT;
+
+        out[i] = value < 0 ? 0 : value > NNUE_ACTIVATION_MAX ? NNUE_ACTIVATION_MAX : value;
+    }
+}
+
+int nnue_evaluate(struct board *board, enum color color) {
+    assert(board != NULL);
+    assert(nnue_network != NULL);
+
+    struct nnue_accumulator scratch;
+    const struct nnue_accumulator *acc = nnue_get_accumulator(board, &scratch);
+
+    uint8_t input[2*NNUE_HALF_DIMS];
+    uint8_t hidden1[NNUE_HIDDEN1_DIMS];
+    uint8_t hidden2[NNUE_HIDDEN2_DIMS];
+
+    int32_t sums[NNUE_HIDDEN1_DIMS > NNUE_HIDDEN2_DIMS ? NNUE_HIDDEN1_DIMS : NNUE_HIDDEN2_DIMS];
+    int32_t output;
+
+    nnue_kernels->transform(acc->values[color], acc->values[color_flip(color)], input);
+
+    nnue_kernels->affine(input, 2*NNUE_HALF_DIMS, &nnue_network->hidden1_weights[0][0],
+                         nnue_network->hidden1_biases, NNUE_HIDDEN1_DIMS, sums);
+    nnue_activate(sums, NNUE_HIDDEN1_DIMS, hidden1);
+
+    nnue_kernels->affine(hidden1, NNUE_HIDDEN1_DIMS, &nnue_network->hidden2_weights[0][0],
+                         nnue_network->hidden2_biases, NNUE_HIDDEN2_DIMS, sums);
+    nnue_activate(sums, NNUE_HIDDEN2_DIMS, hidden2);
+
+    nnue_kernels->affine(hidden2, NNUE_HIDDEN2_DIMS, nnue_network->output_weights,
+                         &nnue_network->output_bias, 1, &output);
+
+    return output / NNUE_OUTPUT_SCALE;
+}
@@ -4,63 +4,215 @@
 #include "move.h"
 #include "movegen.h"
 
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
 #include <limits.h>
+#include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+#include "dfpn.h"
 #include "eval.h"
+#include "evalcache.h"
+#include "mcts.h"
+#include "movepick.h"
+#include "nnue.h"
+#include "tt.h"
+#include "xboard.h"
+
+/**
+ * State of a thread searching the root position.
+ */
+struct search_thread {
+    pthread_t thread;
 
-static clock_t start = 0;
-static bool stop = false;
-int other_attacks_table[5][6];
+    bool main; // only the main thread reports its results
 
-int quiescent_search(struct board *board, int alpha, int beta);
+    struct board board;
+    struct move_list moves; // root moves, ordered by the latest results
+    struct ordering_info ordering_info;
+    struct pawn_entry *pawn_table; // kept between searches
+    struct material_entry *material_table; // kept between searches
+    struct nnue_accumulator *nnue_table; // allocated once a network is loaded
+
+    const struct search_options *options;
+
+    struct move best_move;
+    int best_score;
+    int depth; // depth of the last completed iteration
+    int passes;
+};
+
+static struct search_thread search_threads[SEARCH_THREADS_MAX];
+static int search_threads_cnt = 1;
+
+static long long start = 0; // wall clock time at which the search started (ms)
+static int time_limit = 0;
+static int nps = 0; // node rate converting the visited nodes to time (0 for wall clock time)
+static bool (*stop_poll)(void) = NULL;
+static bool stop = false; // set once the search has to stop (accessed atomically)
+static unsigned long long nodes = 0; // number of nodes visited by all the threads
+static __thread unsigned long long thread_nodes = 0; // number of nodes visited by the current thread
+
+/**
+ * Moves of a node that are currently being searched by some thread,
+ * identified by the node key combined with the move (ABDADA).
+ */
+static uint64_t search_cs[SEARCH_CS_CNT][SEARCH_CS_WAYS];
+
+int other_attacks_table[PIECE_CNT][PIECE_CNT];
+
+int quiescent_search(struct board *board, int alpha, int beta, int ply);
+
+/**
+ * Get the current wall clock time in milliseconds.
+ */
+static long long search_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
 
-static bool check_limits() {
-    if(clock() - start >= 5 * CLOCKS_PER_SEC) {
-        return true;
+/**
+ * Get the time elapsed since the search started in milliseconds, measured
+ * in visited nodes when searching at a fixed node rate so that the results
+ * do not depend on the speed or load of the machine.
+ */
+static long long search_elapsed(void) {
+    if (nps > 0) {
+        return __atomic_load_n(&nodes, __ATOMIC_RELAXED) * 1000 / nps;
     }
 
-    return false;
+    return search_time() - start;
 }
 
-static bool qhas_next(struct move_list *moves) {
-    return moves->head < moves->captured_pieces;
+bool search_stopped(void) {
+    return __atomic_load_n(&stop, __ATOMIC_RELAXED);
 }
 
-static bool ghas_next(struct move_list *moves) {
-    return moves->head < moves->count;
+void search_stop(void) {
+    __atomic_store_n(&stop, true, __ATOMIC_RELAXED);
 }
 
-static void qscore_moves(struct move_list *moves) {
-    for (size_t i = 0; i < moves->count; i++) {
-        struct move move = moves->list[i];
+/**
+ * Count the visited node and check whether the search should stop.
+ * The shared node counter and the clock are only updated every
+ * `SEARCH_CHECK_NODES` nodes to keep the threads from contending.
+ */
+static bool check_limits(void) {
+    if (++thread_nodes % SEARCH_CHECK_NODES != 0) {
+        return search_stopped();
+    }
 
-        if (move.flags & MOVE_FLAG_CAPTURE) {
-            moves->list[i].score = CAPTURE_BONUS + other_attacks_table[move.capture][move.piece];
-        } else if (move.flags & MOVE_FLAG_PROMOTION) {
-            moves->list[i].score = PROMOTION_BONUS + get_piece_value(move.piece);
+    __atomic_fetch_add(&nodes, SEARCH_CHECK_NODES, __ATOMIC_RELAXED);
+
+    if (time_limit > 0 && search_elapsed() >= time_limit) {
+        search_stop();
+    }
+
+    if (stop_poll != NULL && stop_poll()) {
+        search_stop();
+    }
+
+    return search_stopped();
+}
+
+bool search_check_limits(void) {
+    return check_limits();
+}
+
+/**
+ * Identify a move of the given position in the currently searching table.
+ */
+static uint64_t search_move_key(struct board *board, struct move move) {
+    uint64_t m = move.from | move.to << 6 | (move.flags & MOVE_FLAG_PROMOTION ? move.promotion : 0) << 12;
+
+    return board->key ^ ((m + 1) * UINT64_C(0x9E3779B97F4A7C15));
+}
+
+/**
+ * Check whether a move should be deferred because another thread is searching it.
+ */
+static bool search_defer_move(uint64_t move_key, int depth) {
+    if (search_threads_cnt == 1 || depth < SEARCH_DEFER_DEPTH) {
+        return false;
+    }
+
+    uint64_t *ways = search_cs[move_key & (SEARCH_CS_CNT-1)];
+
+    for (int i = 0; i < SEARCH_CS_WAYS; i++) {
+        if (__atomic_load_n(&ways[i], __ATOMIC_RELAXED) == move_key) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Mark a move as being searched by the current thread.
+ */
+static void search_starting(uint64_t move_key, int depth) {
+    if (search_threads_cnt == 1 || depth < SEARCH_DEFER_DEPTH) {
+        return;
+    }
+
+    uint64_t *ways = search_cs[move_key & (SEARCH_CS_CNT-1)];
+
+    for (int i = 0; i < SEARCH_CS_WAYS; i++) {
+        uint64_t key = __atomic_load_n(&ways[i], __ATOMIC_RELAXED);
+
+        if (key == 0 || key == move_key) {
+            __atomic_store_n(&ways[i], move_key, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+
+    __atomic_store_n(&ways[0], move_key, __ATOMIC_RELAXED);
+}
+
+/**
+ * Unmark a move marked by `search_starting`.
+ */
+static void search_finished(uint64_t move_key, int depth) {
+    if (search_threads_cnt == 1 || depth < SEARCH_DEFER_DEPTH) {
+        return;
+    }
+
+    uint64_t *ways = search_cs[move_key & (SEARCH_CS_CNT-1)];
+
+    for (int i = 0; i < SEARCH_CS_WAYS; i++) {
+        if (__atomic_load_n(&ways[i], __ATOMIC_RELAXED) == move_key) {
+            __atomic_store_n(&ways[i], 0, __ATOMIC_RELAXED);
         }
     }
 }
 
-static bool compare_move(struct move m1, struct move m2) {
-    return (m1.capture == m2.capture) && (m1.flags == m2.flags) &&
-    (m1.from == m2.from) && (m1.piece == m2.piece) && (m1.promotion == m2.promotion)
-    && (m1.to == m2.to);
+static bool ghas_next(struct move_list *moves) {
+    return moves->head < moves->count;
 }
 
-static void gscore_moves(struct move_list *moves, struct ordering_info *ordering_info, struct board *board) {
+static void gscore_moves(struct move_list *moves, struct ordering_info *ordering_info, struct board *board, struct move hash_move) {
+    // moves are only scored this way at the root
+    struct search_stack *ss = &ordering_info->stack[SEARCH_STACK_OFFSET];
+
     for (size_t i = 0; i < moves->count; i++) {
         struct move move = moves->list[i];
 
-        if (move.flags & MOVE_FLAG_CAPTURE) {
+        if (move_equal(move, hash_move)) {
+            moves->list[i].score = HASH_MOVE_BONUS;
+        } else if (move.flags & MOVE_FLAG_CAPTURE) {
             moves->list[i].score = CAPTURE_BONUS + other_attacks_table[move.capture][move.piece];
         } else if (move.flags & MOVE_FLAG_PROMOTION) {
             moves->list[i].score = PROMOTION_BONUS + get_piece_value(move.promotion);
-        } else if (compare_move(move, ordering_info->killer1[ordering_info->ply])) {
+        } else if (move_equal(move, ss->killers[0])) {
             moves->list[i].score = KILLER1_BONUS;
-        } else if (compare_move(move, ordering_info->killer2[ordering_info->ply])) {
+        } else if (move_equal(move, ss->killers[1])) {
             moves->list[i].score = KILLER2_BONUS;
         } else { // Quiet
             moves->list[i].score = QUIET_BONUS + ordering_info->history[board->color][move.from][move.to];
@@ -80,35 +232,19 @@ void init_other_moves_table() {
     }
 }
 
-static void init_qmove_picker(struct move_list *moves) {
-    moves->head = 0;
-
-    moves->captured_pieces = 0;
-
-    for (size_t i = 0; i < moves->count; i++) {
-        if (moves->list[i].flags & MOVE_FLAG_CAPTURE) {
-            moves->captured_pieces++;
-        }
-    }
-
-    qscore_moves(moves);
-}
-
-static void init_gmove_picker(struct move_list *moves, struct ordering_info *ordering_info, struct board *board) {
+static void init_gmove_picker(struct move_list *moves, struct ordering_info *ordering_info, struct board *board, struct move hash_move) {
     moves->head = 0;
 
-    gscore_moves(moves, ordering_info, board);
+    gscore_moves(moves, ordering_info, board, hash_move);
 }
 
-static struct move qget_next(struct move_list *moves) {
+struct move gget_next(struct move_list *moves) {
     size_t best_index = 0;
     int best_score = INT_MIN / 2;
 
     for (size_t i = moves->head; i < moves->count; i++) {
-        int current_score = moves->list[i].score;
-
-        if ((moves->list[i].flags & (MOVE_FLAG_CAPTURE | MOVE_FLAG_PROMOTION)) && (current_score > best_score)) {
-            best_score = current_score;
+        if (moves->list[i].score > best_score) {
+            best_score = moves->list[i].score;
             best_index = i;
         }
     }
@@ -120,186 +256,1019 @@ static struct move qget_next(struct move_list *moves) {
     return moves->list[moves->head++];
 }
 
-struct move gget_next(struct move_list *moves) {
-    size_t best_index = 0;
-    int best_score = INT_MIN / 2;
+static void init_ordering_info(struct ordering_info *ordering_info) {
+    ordering_info->depth = 0;
+    ordering_info->extensions = 0;
 
-    for (size_t i = moves->head; i < moves->count; i++) {
-        if (moves->list[i].score > best_score) {
-            best_score = moves->list[i].score;
-            best_index = i;
+    for (size_t i = 0; i < sizeof(ordering_info->stack)/sizeof(*ordering_info->stack); i++) {
+        struct search_stack *ss = &ordering_info->stack[i];
+
+        ss->ply = (int)i - SEARCH_STACK_OFFSET;
+        ss->killers[0].flags = MOVE_FLAG_INVALID;
+        ss->killers[1].flags = MOVE_FLAG_INVALID;
+        ss->current.flags = MOVE_FLAG_INVALID;
+        ss->excluded.flags = MOVE_FLAG_INVALID;
+        ss->static_eval = SEARCH_EVAL_NONE;
+        ss->in_check = false;
+    }
+
+    for (enum color c = 0; c < COLOR_CNT; c++) {
+        for (enum piece p = 0; p < PIECE_CNT; p++) {
+            for (enum square s = 0; s < SQ_CNT; s++) {
+                ordering_info->counter[c][p][s].flags = MOVE_FLAG_INVALID;
+            }
         }
     }
 
-    struct move aux = moves->list[moves->head];
-    moves->list[moves->head] = moves->list[best_index];
-    moves->list[best_index] = aux;
+    memset(ordering_info->history, 0, sizeof(ordering_info->history));
+}
 
-    return moves->list[moves->head++];
+/**
+ * Evaluate a position from the point of view of its side to move,
+ * looking it up in the evaluation cache first. Positions that evaluate
+ * far enough outside the (`alpha`, `beta`) window are only evaluated
+ * lazily (see `evaluate_lazy`) and their partial scores are not cached.
+ */
+static int search_evaluate_lazy(struct board *board, int alpha, int beta) {
+    int score;
+
+    if (ec_probe(board->key, &score)) {
+        return score;
+    }
+
+    score = evaluate_lazy(board, board->color, alpha, beta);
+
+    if (score + LAZY_EVAL_MARGIN > alpha && score - LAZY_EVAL_MARGIN < beta) {
+        ec_store(board->key, score);
+    }
+
+    return score;
 }
 
-static int search_negamax(struct board *board, size_t depth, int alpha, int beta, struct ordering_info *ordering_info) {
+/**
+ * Evaluate a position from the point of view of its side to move,
+ * looking it up in the evaluation cache first.
+ */
+static int search_evaluate(struct board *board) {
+    return search_evaluate_lazy(board, INT_MIN, INT_MAX);
+}
+
+static int search_negamax(struct board *board, int depth, int alpha, int beta,
+                          struct ordering_info *ordering_info, struct search_stack *ss) {
     if (board->halfmove_clock >= 50) {
-        return evaluate(board, board->color);
+        return search_evaluate(board);
     }
 
-    struct move_list moves;
-    movegen_add_moves(&moves, board);
+    if (depth <= 0) {
+        return quiescent_search(board, alpha, beta, 0);
+    }
 
-    init_gmove_picker(&moves, ordering_info, board);
+    if (check_limits()) {
+        return 0;
+    }
 
-    // checkmate or stalemate
-    if (moves.count == 0) {
-        return board_color_in_check(board, board->color) ? INT_MIN / 2 : 0;
+    // the search stack bounds the length of the searched lines
+    if (ss->ply >= SEARCH_PLY_MAX) {
+        return search_evaluate(board);
     }
 
-    if (depth == 0) {
-        return quiescent_search(board, alpha, beta);
+    struct move excluded = ss->excluded;
+
+    // the position is being searched without one of its moves,
+    // so the hash table result does not apply to it
+    bool excluding = excluded.flags != MOVE_FLAG_INVALID;
+
+    struct tt_entry entry = { .move.flags = MOVE_FLAG_INVALID, .bound = TT_BOUND_NONE };
+
+    if (!excluding) {
+        tt_probe(board->key, &entry);
+    }
+
+    if (entry.bound != TT_BOUND_NONE && entry.depth >= depth && ss->ply > 0) {
+        if (entry.bound == TT_BOUND_EXACT) {
+            return entry.score;
+        }
+
+        if (entry.bound == TT_BOUND_LOWER && entry.score >= beta) {
+            return entry.score;
+        }
+
+        if (entry.bound == TT_BOUND_UPPER && entry.score <= alpha) {
+            return entry.score;
+        }
+    }
+
+    struct move hash_move = entry.move;
+
+    // Without a hash move the moves are poorly ordered, so the node is
+    // searched one ply shallower; its hash move will then order the next
+    // iteration (internal iterative reductions). Ordering matters most
+    // near the root, where the reduction is applied.
+    if (!excluding && depth >= SEARCH_IIR_DEPTH && hash_move.flags == MOVE_FLAG_INVALID) {
+        depth--;
     }
-    
+
+    ss->in_check = board_color_in_check(board, board->color);
+    ss->static_eval = ss->in_check ? SEARCH_EVAL_NONE : search_evaluate(board);
+
+    // ProbCut: if a good capture beats beta by a margin in a shallow search,
+    // the full-depth search would most likely fail high as well
+    int probcut_beta = beta + SEARCH_PROBCUT_MARGIN;
+
+    if (beta - alpha == 1 && !excluding && !ss->in_check && depth >= SEARCH_PROBCUT_DEPTH &&
+        beta > -SEARCH_MATE_BOUND && beta < SEARCH_MATE_BOUND &&
+        !(entry.bound != TT_BOUND_NONE && entry.depth >= depth - (SEARCH_PROBCUT_REDUCTION-1) &&
+          entry.score < probcut_beta))
+    {
+        struct move_picker picker;
+        mp_init_captures(&picker, board);
+
+        struct move move;
+
+        while ((move = mp_next(&picker)).flags != MOVE_FLAG_INVALID) {
+            // only captures that win enough material to reach the raised beta
+            if (static_exchange_evaluation(board, move) < probcut_beta - ss->static_eval) {
+                continue;
+            }
+
+            struct board board_copy = *board;
+            board_do_move(&board_copy, move);
+
+            ss->current = move;
+
+            // a quiescence search first weeds out the captures that do not hold
+            int score = -quiescent_search(&board_copy, -probcut_beta, -probcut_beta + 1, 0);
+
+            if (score >= probcut_beta) {
+                score = -search_negamax(&board_copy, depth - SEARCH_PROBCUT_REDUCTION, -probcut_beta, -probcut_beta + 1,
+                                        ordering_info, ss+1);
+            }
+
+            if (search_stopped()) {
+                return 0;
+            }
+
+            if (score >= probcut_beta) {
+                tt_store(board->key, move, score, depth - (SEARCH_PROBCUT_REDUCTION-1), TT_BOUND_LOWER);
+
+                return score;
+            }
+        }
+    }
+
+    bool can_extend = ordering_info->extensions < ordering_info->depth;
+
+    // The hash move is singular if all the other moves fail low by a margin
+    // when searched at reduced depth, in which case it gets extended.
+    bool singular = false;
+
+    if (can_extend && !excluding && depth >= SEARCH_SINGULAR_DEPTH &&
+        hash_move.flags != MOVE_FLAG_INVALID &&
+        entry.bound != TT_BOUND_UPPER && entry.depth >= depth-3 &&
+        entry.score > INT_MIN / 4 && entry.score < INT_MAX / 4)
+    {
+        int singular_beta = entry.score - SEARCH_SINGULAR_MARGIN * depth;
+
+        ss->excluded = hash_move;
+        int score = search_negamax(board, depth / 2, singular_beta - 1, singular_beta, ordering_info, ss);
+        ss->excluded.flags = MOVE_FLAG_INVALID;
+
+        if (search_stopped()) {
+            return 0;
+        }
+
+        singular = score < singular_beta;
+    }
+
+    struct move previous = (ss-1)->current;
+
+    // moves are generated lazily, in stages, so a cutoff
+    // on an early move skips generating the later ones
+    struct move_picker picker;
+    mp_init(&picker, board, ordering_info, ss, hash_move);
+
+    // the search fails soft: the returned score may lie outside
+    // the window, which gives tighter bounds to the hash table
+    // and lets zero-window drivers converge faster
+    struct move best_move = { .flags = MOVE_FLAG_INVALID };
+    int best_score = INT_MIN / 2;
+
     bool full_window = true;
 
-    while(ghas_next(&moves)) {
-        struct move move = gget_next(&moves);
+    int move_count = 0;
+    int searched_cnt = 0;
 
-        struct board board_copy = *board;
-        board_do_move(&board_copy, move);
+    // Late move pruning: near the leaves, quiet moves ordered after the first
+    // few are unlikely to raise alpha, so only those giving check are still
+    // searched and, far enough past the count, the remaining quiet moves are
+    // skipped without being generated. Fewer are kept when the static
+    // evaluation has dropped since the side to move last moved (not improving).
+    bool improving = !ss->in_check &&
+                     ((ss-2)->static_eval == SEARCH_EVAL_NONE || ss->static_eval > (ss-2)->static_eval);
+
+    bool lmp = !ss->in_check && ss->ply > 0 && depth <= SEARCH_LMP_DEPTH;
+    int lmp_cnt = (3 + depth * depth) / (improving ? 1 : 2);
+
+    int quiet_cnt = 0;
+
+    // moves postponed because other threads were searching them
+    struct move deferred[MOVE_LIST_MAX];
+    size_t deferred_cnt = 0;
+    size_t deferred_idx = 0;
+
+    struct move move;
+
+    while (true) {
+        bool deferred_move = false;
+
+        if ((move = mp_next(&picker)).flags != MOVE_FLAG_INVALID) {
+            move_count++;
+        } else if (deferred_idx < deferred_cnt) {
+            move = deferred[deferred_idx++];
+            deferred_move = true;
+        } else {
+            break;
+        }
+
+        if (excluding && move_equal(move, excluded)) {
+            continue;
+        }
+
+        bool quiet = !(move.flags & (MOVE_FLAG_CAPTURE | MOVE_FLAG_PROMOTION | MOVE_FLAG_EN_PASSANT));
+
+        if (quiet && !deferred_move) {
+            quiet_cnt++;
+        }
+
+        // the move is made once, by the pruning test or before being searched
+        struct board board_copy;
+        bool made = false;
+
+        // a move that avoids being mated has to be found first
+        if (lmp && quiet && quiet_cnt > lmp_cnt && best_score > -SEARCH_MATE_BOUND) {
+            if (quiet_cnt > 2 * lmp_cnt) {
+                mp_skip_quiets(&picker);
+                continue;
+            }
+
+            board_copy = *board;
+            board_do_move(&board_copy, move);
+            made = true;
+
+            if (!board_color_in_check(&board_copy, board_copy.color)) {
+                continue;
+            }
+        }
+
+        uint64_t move_key = search_move_key(board, move);
+
+        // the first move is always searched right away (young brothers wait),
+        // the others are left for later while another thread searches them
+        if (!deferred_move && searched_cnt > 0 && search_defer_move(move_key, depth)) {
+            deferred[deferred_cnt++] = move;
+            continue;
+        }
+
+        searched_cnt++;
+
+        if (!made) {
+            board_copy = *board;
+            board_do_move(&board_copy, move);
+        }
+
+        ec_prefetch(board_copy.key);
+
+        int extension = 0;
+
+        if (can_extend) {
+            if (board_color_in_check(&board_copy, board_copy.color)) {
+                extension = 1; // check extension
+            } else if ((move.flags & MOVE_FLAG_CAPTURE) && (previous.flags & MOVE_FLAG_CAPTURE) && move.to == previous.to) {
+                extension = 1; // recapture extension
+            } else if (singular && move_equal(move, hash_move)) {
+                extension = 1; // singular extension
+            }
+        }
 
         int score;
 
-        ordering_info->ply++;
+        search_starting(move_key, depth);
+
+        ss->current = move;
+        ordering_info->extensions += extension;
         if (full_window) {
-            score = -search_negamax(&board_copy, depth-1, -beta, -alpha, ordering_info);
+            score = -search_negamax(&board_copy, depth-1+extension, -beta, -alpha, ordering_info, ss+1);
         } else {
-            score = -search_negamax(&board_copy, depth-1, -alpha - 1, -alpha, ordering_info);
+            score = -search_negamax(&board_copy, depth-1+extension, -alpha - 1, -alpha, ordering_info, ss+1);
 
             if (score > alpha) {
-                score = -search_negamax(&board_copy, depth-1, -beta, -alpha, ordering_info);
+                score = -search_negamax(&board_copy, depth-1+extension, -beta, -alpha, ordering_info, ss+1);
             }
         }
-        ordering_info->ply--;
+        ordering_info->extensions -= extension;
+
+        search_finished(move_key, depth);
+
+        if (search_stopped()) {
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_score = score;
+        }
 
         if (score >= beta) {
-            // Add this move as a new killer move and update history if move is quiet
-            ordering_info->killer2[ordering_info->ply] = ordering_info->killer1[ordering_info->ply];
-              ordering_info->killer1[ordering_info->ply] = move;
-            
-            if (!(move.flags & MOVE_FLAG_CAPTURE)) {
+            // Add this move as a new killer move and counter move and update history if move is quiet
+            if (!(move.flags & (MOVE_FLAG_CAPTURE | MOVE_FLAG_PROMOTION | MOVE_FLAG_EN_PASSANT))) {
+                if (!move_equal(move, ss->killers[0])) {
+                    ss->killers[1] = ss->killers[0];
+                    ss->killers[0] = move;
+                }
+
+                if (previous.flags != MOVE_FLAG_INVALID) {
+                    ordering_info->counter[color_flip(board->color)][previous.piece][previous.to] = move;
+                }
+
                 ordering_info->history[board->color][move.from][move.to] += depth * depth;
             }
 
-            return beta;
+            if (!excluding) {
+                tt_store(board->key, move, score, depth, TT_BOUND_LOWER);
+            }
+
+            return score;
         }
 
         if (score > alpha) {
             full_window = false;
+            best_move = move;
             alpha = score;
         }
     }
 
-    return alpha;
+    // checkmate or stalemate
+    if (move_count == 0) {
+        return board_color_in_check(board, board->color) ? INT_MIN / 2 : 0;
+    }
+
+    if (!excluding) {
+        tt_store(board->key, best_move, best_score, depth,
+                 best_move.flags != MOVE_FLAG_INVALID ? TT_BOUND_EXACT : TT_BOUND_UPPER);
+    }
+
+    return best_score;
 }
-#include "xboard.h"
-struct move search_best_move(struct board *board) {
-    start = clock();
-    stop = false;
-    struct ordering_info ordering_info;
-    ordering_info.ply = 0;
-    memset(ordering_info.history, 0, sizeof(ordering_info.history));
+/**
+ * Collect into `pv` the principal variation starting with the given root move
+ * by following the hash moves stored in the transposition table.
+ */
+static size_t search_get_pv(struct board *board, struct move move, struct move pv[SEARCH_PV_LEN_MAX]) {
+    struct board board_copy = *board;
 
-    struct move_list moves;
-    movegen_add_moves(&moves, board);
+    size_t len = 0;
 
-    init_gmove_picker(&moves, &ordering_info, board);
+    pv[len++] = move;
+    board_do_move(&board_copy, move);
 
-    struct move best_move = { .flags = MOVE_FLAG_INVALID };
+    while (len < SEARCH_PV_LEN_MAX) {
+        struct tt_entry entry;
 
-    int current_score = 0;
-    int alpha = INT_MIN / 2;
-    int beta = INT_MAX / 2;
+        if (!tt_probe(board_copy.key, &entry) || entry.move.flags == MOVE_FLAG_INVALID ||
+            !movegen_is_legal(&board_copy, entry.move))
+        {
+            break;
+        }
+
+        pv[len++] = entry.move;
+        board_do_move(&board_copy, entry.move);
+    }
+
+    return len;
+}
+
+/**
+ * Send the thinking output for a principal variation to xboard.
+ */
+static void search_post(int depth, int score, const struct move *pv, size_t len) {
+    // xboard expects mate scores to be reported as +/-100000
+    if (score >= SEARCH_MATE_BOUND) {
+        score = 100000;
+    } else if (score <= -SEARCH_MATE_BOUND) {
+        score = -100000;
+    }
+
+    xb_print("%d %d %lld %llu", depth, score, search_elapsed() / 10,
+             __atomic_load_n(&nodes, __ATOMIC_RELAXED) + thread_nodes % SEARCH_CHECK_NODES);
+
+    for (size_t i = 0; i < len; i++) {
+        xb_print(" %s", square_to_str(pv[i].from));
+        xb_print("%s", square_to_str(pv[i].to));
+
+        if (pv[i].flags & MOVE_FLAG_PROMOTION) {
+            xb_print("%c", piece_to_char(BLACK, pv[i].promotion));
+        }
+    }
+
+    xb_print("\n");
+}
+
+/**
+ * Search the root moves starting from index `first` (the ones before it
+ * are excluded) within the given window and, unless all of them fail low,
+ * move the best one found to index `first` and store its principal
+ * variation into `pv`.
+ * Returns the score of the best move, which is exact if inside the window
+ * and a bound otherwise.
+ */
+static int search_root(struct board *board, struct move_list *moves, size_t first, int depth, int alpha, int beta,
+                       struct ordering_info *ordering_info, struct move pv[SEARCH_PV_LEN_MAX], size_t *pv_len) {
+    assert(first < moves->count);
+
+    struct search_stack *ss = &ordering_info->stack[SEARCH_STACK_OFFSET];
+
+    ss->in_check = board_color_in_check(board, board->color);
+    ss->static_eval = ss->in_check ? SEARCH_EVAL_NONE : search_evaluate(board);
+
+    int alpha_orig = alpha;
+
+    size_t best_index = first;
+    int best_score = INT_MIN / 2;
 
     bool full_window = true;
 
-    while (ghas_next(&moves)) {
-        xb_commentln("loop");
-        xb_commentln("%i %i", moves.head, moves.count);
+    // indices of the moves postponed because other threads were searching them
+    size_t deferred[MOVE_LIST_MAX];
+    size_t deferred_cnt = 0;
+    size_t deferred_idx = 0;
 
-        struct move move = gget_next(&moves);
+    for (size_t j = first; j < moves->count || deferred_idx < deferred_cnt; j++) {
+        size_t i = j < moves->count ? j : deferred[deferred_idx++];
+
+        struct move move = moves->list[i];
+
+        uint64_t move_key = search_move_key(board, move);
+
+        if (j < moves->count && j > first && search_defer_move(move_key, depth)) {
+            deferred[deferred_cnt++] = i;
+            continue;
+        }
 
         struct board board_copy = *board;
         board_do_move(&board_copy, move);
 
-        ordering_info.ply++;
+        int score;
+
+        search_starting(move_key, depth);
+
+        ss->current = move;
         if (full_window) {
-            current_score = -search_negamax(&board_copy, SEARCH_DEPTH-1, -beta, -alpha, &ordering_info);
+            score = -search_negamax(&board_copy, depth-1, -beta, -alpha, ordering_info, ss+1);
         } else {
-            current_score = -search_negamax(&board_copy, SEARCH_DEPTH-1, -alpha - 1, -alpha, &ordering_info);
-            if (current_score > alpha) {
-                current_score = -search_negamax(&board_copy, SEARCH_DEPTH-1, -beta, -alpha, &ordering_info);
+            score = -search_negamax(&board_copy, depth-1, -alpha - 1, -alpha, ordering_info, ss+1);
+            if (score > alpha && score < beta) {
+                score = -search_negamax(&board_copy, depth-1, -beta, -alpha, ordering_info, ss+1);
             }
         }
-        ordering_info.ply--;
 
-        if (current_score > alpha) {
+        search_finished(move_key, depth);
+
+        if (search_stopped()) {
+            return 0;
+        }
+
+        if (score > best_score) {
+            best_index = i;
+            best_score = score;
+        }
+
+        if (score > alpha) {
             full_window = false;
-            best_move = move;
-            alpha = current_score;
+            alpha = score;
 
-            if (current_score == INT_MAX/2) {
+            // collect the variation before the searches of the
+            // other moves overwrite its hash table entries
+            *pv_len = search_get_pv(board, move, pv);
+
+            if (score >= beta || score >= INT_MAX/2) {
                 break;
             }
         }
     }
 
-    if (best_move.flags == MOVE_FLAG_INVALID) {
-        best_move = moves.list[0];
+    // all the moves failed low, so none of them is known to be the best
+    if (best_score <= alpha_orig && alpha_orig > INT_MIN / 2) {
+        return best_score;
+    }
+
+    if (full_window) {
+        *pv_len = search_get_pv(board, moves->list[best_index], pv);
     }
 
-    xb_commentln("BEST MOVE SCORE :: %d", current_score);
+    // keep the remaining moves in their current order so that the
+    // next line and the next iteration search them in the same order
+    struct move best_move = moves->list[best_index];
+    memmove(&moves->list[first+1], &moves->list[first], (best_index - first) * sizeof *moves->list);
+    moves->list[first] = best_move;
 
-    return best_move;
+    return best_score;
 }
 
-int quiescent_search(struct board *board, int alpha, int beta) {
-    if (stop || check_limits()) {
-        stop = true;
-        return 0;
+/**
+ * Find the exact score of the best root move starting from index `first`
+ * with a sequence of zero-window searches (MTD(f)), starting from `guess`
+ * (usually the score of the previous iteration).
+ * Each pass either raises the lower bound or lowers the upper bound
+ * of the score until the two meet; the hash table keeps the passes
+ * from searching the same subtrees over again.
+ */
+static int search_root_mtdf(struct board *board, struct move_list *moves, size_t first, int depth, int guess,
+                            struct ordering_info *ordering_info, struct move pv[SEARCH_PV_LEN_MAX], size_t *pv_len,
+                            int *passes) {
+    int lower = INT_MIN / 2;
+    int upper = INT_MAX / 2;
+
+    int score = guess;
+
+    while (lower < upper) {
+        int beta = score == lower ? score + 1 : score;
+
+        score = search_root(board, moves, first, depth, beta - 1, beta, ordering_info, pv, pv_len);
+
+        ++*passes;
+
+        if (search_stopped()) {
+            return 0;
+        }
+
+        if (score < beta) {
+            upper = score;
+        } else {
+            lower = score;
+        }
     }
 
-    struct move_list moves;
-    movegen_add_moves(&moves, board);
+    // the best move of the last pass failing high is the one at `first`
+    *pv_len = search_get_pv(board, moves->list[first], pv);
 
-    // checkmate or stalemate
-    if (moves.count == 0) {
-        return board_color_in_check(board, board->color) ? INT_MIN : 0;
+    return score;
+}
+
+bool search_is_excluded(const struct search_options *options, struct move move) {
+    assert(options != NULL);
+
+    for (size_t i = 0; i < options->excluded_cnt; i++) {
+        if (move_equal(options->excluded[i], move)) {
+            return true;
+        }
     }
 
-    int stand_pat = evaluate(board, board->color);
+    return false;
+}
 
-    init_qmove_picker(&moves);
+const char *search_algorithm_strs[SEARCH_ALGORITHM_CNT] = {
+    [SEARCH_ALGORITHM_PVS]  = "PVS",
+    [SEARCH_ALGORITHM_MTDF] = "MTD(f)",
+    [SEARCH_ALGORITHM_MCTS] = "MCTS",
+    [SEARCH_ALGORITHM_DFPN] = "df-pn",
+};
 
-    if (!qhas_next(&moves)) {
-        return stand_pat;
+enum search_algorithm search_str_to_algorithm(const char *str) {
+    assert(str != NULL);
+
+    for (enum search_algorithm i = 0; i < SEARCH_ALGORITHM_CNT; i++) {
+        if (strcmp(search_algorithm_strs[i], str) == 0) {
+            return i;
+        }
+    }
+
+    return SEARCH_ALGORITHM_UNKNOWN;
+}
+
+int search_probe(struct board *board, int depth, struct ordering_info *ordering_info) {
+    ordering_info->depth = depth;
+
+    return search_negamax(board, depth, INT_MIN / 2, INT_MAX / 2, ordering_info,
+                          &ordering_info->stack[SEARCH_STACK_OFFSET]);
+}
+
+/**
+ * Search the root position of a thread with iterative deepening
+ * (or grow the shared search tree in MCTS mode).
+ */
+static void search_iterate(struct search_thread *thread) {
+    const struct search_options *options = thread->options;
+
+    struct board *board = &thread->board;
+    struct move_list *moves = &thread->moves;
+    struct ordering_info *ordering_info = &thread->ordering_info;
+
+    thread_nodes = 0;
+
+    eval_set_tables(thread->pawn_table, thread->material_table);
+    nnue_set_table(thread->nnue_table);
+
+    if (options->algorithm == SEARCH_ALGORITHM_MCTS) {
+        mcts_run(board, ordering_info);
+
+        __atomic_fetch_add(&nodes, thread_nodes % SEARCH_CHECK_NODES, __ATOMIC_RELAXED);
+        ec_flush_stats();
+
+        return;
+    }
+
+    size_t multi_pv = (size_t)options->multi_pv < moves->count ? (size_t)options->multi_pv : moves->count;
+
+    // previous iteration scores of each line, used as
+    // first guesses by the zero-window driver
+    int scores[SEARCH_MULTI_PV_MAX];
+
+    for (size_t pv = 0; pv < multi_pv; pv++) {
+        scores[pv] = search_evaluate(board);
+    }
+
+    // iterative deepening: each iteration seeds the move ordering
+    // of the next one through the hash table and the root move order
+    for (int depth = 1; depth <= options->depth; depth++) {
+        ordering_info->depth = depth;
+
+        // each line excludes the best moves of the previous ones and
+        // shares the hash table and the killer and history tables with them
+        for (size_t pv = 0; pv < multi_pv; pv++) {
+            struct move pv_moves[SEARCH_PV_LEN_MAX];
+            size_t pv_len = 0;
+
+            int score;
+
+            switch (options->algorithm) {
+            case SEARCH_ALGORITHM_MTDF:
+                score = search_root_mtdf(board, moves, pv, depth, scores[pv], ordering_info, pv_moves, &pv_len, &thread->passes);
+                break;
+
+            default:
+                score = search_root(board, moves, pv, depth, INT_MIN / 2, INT_MAX / 2, ordering_info, pv_moves, &pv_len);
+                thread->passes++;
+                break;
+            }
+
+            // results of an interrupted line are unreliable
+            if (search_stopped()) {
+                break;
+            }
+
+            scores[pv] = score;
+
+            if (pv == 0) {
+                thread->best_move = moves->list[0];
+                thread->best_score = score;
+                thread->depth = depth;
+
+                // with moves excluded the score is not the position's one
+                if (options->excluded_cnt == 0) {
+                    tt_store(board->key, thread->best_move, thread->best_score, depth, TT_BOUND_EXACT);
+                }
+            }
+
+            if (thread->main) {
+                if (options->post) {
+                    search_post(depth, score, pv_moves, pv_len);
+                }
+
+                xb_commentln("DEPTH %d PV %zu BEST MOVE SCORE :: %d", depth, pv+1, score);
+            }
+        }
+
+        if (search_stopped() || thread->best_score >= INT_MAX/2) {
+            break;
+        }
+    }
+
+    __atomic_fetch_add(&nodes, thread_nodes % SEARCH_CHECK_NODES, __ATOMIC_RELAXED);
+    ec_flush_stats();
+}
+
+/**
+ * Entry point of the helper threads.
+ */
+static void * search_thread_run(void *arg) {
+    search_iterate(arg);
+
+    return NULL;
+}
+
+void search_term(void) {
+    for (int i = 0; i < SEARCH_THREADS_MAX; i++) {
+        free(search_threads[i].pawn_table);
+        search_threads[i].pawn_table = NULL;
+
+        free(search_threads[i].material_table);
+        search_threads[i].material_table = NULL;
+
+        free(search_threads[i].nnue_table);
+        search_threads[i].nnue_table = NULL;
+    }
+}
+
+struct move search_best_move(struct board *board, const struct search_options *options, struct search_stats *stats) {
+    assert(options != NULL);
+    assert(options->algorithm >= 0 && options->algorithm < SEARCH_ALGORITHM_CNT);
+    assert(options->multi_pv >= 1 && options->multi_pv <= SEARCH_MULTI_PV_MAX);
+    assert(options->threads >= 1 && options->threads <= SEARCH_THREADS_MAX);
+    assert(options->depth >= 1 && options->depth <= SEARCH_DEPTH_MAX);
+    assert(options->nps >= 0);
+
+    start = search_time();
+    time_limit = options->time_limit;
+    nps = options->nps;
+    stop_poll = options->stop_poll;
+    __atomic_store_n(&stop, false, __ATOMIC_RELAXED);
+    nodes = 0;
+
+    search_threads_cnt = options->threads;
+    memset(search_cs, 0, sizeof(search_cs));
+
+    unsigned long long ec_hits_start, ec_misses_start;
+    ec_get_stats(&ec_hits_start, &ec_misses_start);
+
+    struct search_thread *main_thread = &search_threads[0];
+
+    struct move_list *moves = &main_thread->moves;
+    movegen_add_moves(moves, board);
+
+    // excluded root moves are dropped before any of them is searched
+    for (size_t i = 0; i < moves->count; ) {
+        if (search_is_excluded(options, moves->list[i])) {
+            moves->list[i] = moves->list[--moves->count];
+        } else {
+            i++;
+        }
+    }
+
+    if (moves->count == 0) {
+        if (stats != NULL) {
+            *stats = (struct search_stats){ .nodes = 0 };
+        }
+
+        return (struct move){ .flags = MOVE_FLAG_INVALID };
+    }
+
+    init_ordering_info(&main_thread->ordering_info);
+
+    struct tt_entry entry;
+    struct move hash_move = tt_probe(board->key, &entry) ? entry.move : (struct move){ .flags = MOVE_FLAG_INVALID };
+
+    // sort the root moves once; each iteration then leaves
+    // them ordered by its results for the next one
+    init_gmove_picker(moves, &main_thread->ordering_info, board, hash_move);
+
+    while (ghas_next(moves)) {
+        gget_next(moves);
+    }
+
+    // df-pn only answers whether there is a mate; the other
+    // positions are searched by PVS within the time left
+    if (options->algorithm == SEARCH_ALGORITHM_DFPN) {
+        struct move pv_moves[SEARCH_PV_LEN_MAX];
+
+        thread_nodes = 0;
+
+        int mate_max = options->depth < DFPN_MATE_MAX ? options->depth : DFPN_MATE_MAX;
+        size_t pv_len = dfpn_solve(board, moves, mate_max, pv_moves);
+
+        __atomic_fetch_add(&nodes, thread_nodes % SEARCH_CHECK_NODES, __ATOMIC_RELAXED);
+
+        xb_commentln("%s :: %s IN %d NODES %llu", search_algorithm_strs[options->algorithm],
+                     pv_len > 0 ? "MATE" : "NO MATE", mate_max, dfpn_get_nodes());
+
+        if (pv_len > 0) {
+            if (options->post) {
+                search_post(pv_len, INT_MAX / 2, pv_moves, pv_len);
+            }
+
+            if (stats != NULL) {
+                stats->nodes = nodes;
+                stats->passes = 1;
+                stats->depth = pv_len;
+                stats->score = INT_MAX / 2;
+            }
+
+            return pv_moves[0];
+        }
+    }
+
+    if (options->algorithm == SEARCH_ALGORITHM_MCTS) {
+        mcts_reset(board, moves);
+    }
+
+    // the helper threads search the same position with their own
+    // ordering data, skipping the moves other threads are busy with,
+    // and share their results through the hash table
+    for (int i = 0; i < search_threads_cnt; i++) {
+        struct search_thread *thread = &search_threads[i];
+
+        if (thread->pawn_table == NULL) {
+            thread->pawn_table = calloc(PAWN_TABLE_CNT, sizeof(*thread->pawn_table));
+
+            if (thread->pawn_table == NULL) {
+                error(EXIT_FAILURE, errno, "could not allocate space for pawn hash table");
+            }
+        }
+
+        if (thread->material_table == NULL) {
+            thread->material_table = calloc(MATERIAL_TABLE_CNT, sizeof(*thread->material_table));
+
+            if (thread->material_table == NULL) {
+                error(EXIT_FAILURE, errno, "could not allocate space for material hash table");
+            }
+        }
+
+        if (thread->nnue_table == NULL && nnue_is_loaded()) {
+            thread->nnue_table = calloc(NNUE_TABLE_CNT, sizeof(*thread->nnue_table));
+
+            if (thread->nnue_table == NULL) {
+                error(EXIT_FAILURE, errno, "could not allocate space for accumulator table");
+            }
+        }
+
+        thread->main = i == 0;
+        thread->board = *board;
+        thread->options = options;
+        thread->best_move = moves->list[0];
+        thread->best_score = 0;
+        thread->depth = 0;
+        thread->passes = 0;
+
+        if (i > 0) {
+            thread->moves = *moves;
+            init_ordering_info(&thread->ordering_info);
+
+            if (pthread_create(&thread->thread, NULL, search_thread_run, thread) != 0) {
+                search_threads_cnt = i;
+                break;
+            }
+        }
+    }
+
+    search_iterate(main_thread);
+
+    search_stop();
+
+    for (int i = 1; i < search_threads_cnt; i++) {
+        pthread_join(search_threads[i].thread, NULL);
     }
 
+    // the tree is only reported once all the threads stopped growing it
+    if (options->algorithm == SEARCH_ALGORITHM_MCTS) {
+        main_thread->passes = mcts_get_playouts();
+
+        for (size_t pv = 0; pv < (size_t)options->multi_pv; pv++) {
+            struct move pv_moves[SEARCH_PV_LEN_MAX];
+            int score;
+
+            size_t pv_len = mcts_get_pv(pv, pv_moves, &score);
+
+            if (pv_len == 0) {
+                break;
+            }
+
+            if (pv == 0) {
+                main_thread->best_move = pv_moves[0];
+                main_thread->best_score = score;
+                main_thread->depth = pv_len;
+            }
+
+            if (options->post) {
+                search_post(pv_len, score, pv_moves, pv_len);
+            }
+        }
+    }
+
+    xb_commentln("BEST MOVE SCORE :: %d", main_thread->best_score);
+    xb_commentln("%s :: DEPTH %d PASSES %d NODES %llu THREADS %d", search_algorithm_strs[options->algorithm],
+                 main_thread->depth, main_thread->passes, nodes, search_threads_cnt);
+
+    unsigned long long ec_hits, ec_misses;
+    ec_get_stats(&ec_hits, &ec_misses);
+
+    xb_commentln("EVAL CACHE :: HITS %llu MISSES %llu", ec_hits - ec_hits_start, ec_misses - ec_misses_start);
+
+    if (stats != NULL) {
+        stats->nodes = nodes;
+        stats->passes = main_thread->passes;
+        stats->depth = main_thread->depth;
+        stats->score = main_thread->best_score;
+    }
+
+    return main_thread->best_move;
+}
+
+int quiescent_search(struct board *board, int alpha, int beta, int ply) {
+    if (check_limits()) {
+        return 0;
+    }
+
+    struct move_picker picker;
+
+    struct move move;
+
+    // when in check standing pat is not an option,
+    // so all the evasions are searched instead
+    if (board_color_in_check(board, board->color)) {
+        mp_init(&picker, board, NULL, NULL, (struct move){ .flags = MOVE_FLAG_INVALID });
+
+        move = mp_next(&picker);
+
+        // checkmate
+        if (move.flags == MOVE_FLAG_INVALID) {
+            return INT_MIN / 2;
+        }
+
+        if (ply >= SEARCH_QUIESCENCE_PLY_MAX) {
+            return search_evaluate(board);
+        }
+
+        int best_score = INT_MIN / 2;
+
+        for (; move.flags != MOVE_FLAG_INVALID; move = mp_next(&picker)) {
+            struct board board_copy = *board;
+            board_do_move(&board_copy, move);
+
+            int score = -quiescent_search(&board_copy, -beta, -alpha, ply+1);
+
+            if (search_stopped()) {
+                return 0;
+            }
+
+            if (score >= beta) {
+                return score;
+            }
+
+            if (score > best_score) {
+                best_score = score;
+            }
+
+            if (score > alpha) {
+                alpha = score;
+            }
+        }
+
+        return best_score;
+    }
+
+    // the exact static evaluation only matters close to the window
+    int stand_pat = search_evaluate_lazy(board, alpha, beta);
+
     if (stand_pat >= beta) {
-        return beta;
+        return stand_pat;
     }
 
     if (alpha < stand_pat) {
         alpha = stand_pat;
     }
 
-    while (qhas_next(&moves)) {
-        struct move move = qget_next(&moves);
+    if (ply >= SEARCH_QUIESCENCE_PLY_MAX) {
+        return stand_pat;
+    }
+
+    int best_score = stand_pat;
+
+    // losing captures are not searched
+    mp_init_captures(&picker, board);
+
+    while ((move = mp_next(&picker)).flags != MOVE_FLAG_INVALID) {
+        // delta pruning: skip captures which cannot raise alpha
+        // even if the captured material comes for free
+        int delta = SEARCH_DELTA_MARGIN;
+
+        if (move.flags & MOVE_FLAG_CAPTURE) {
+            delta += get_piece_value(move.capture);
+        } else if (move.flags & MOVE_FLAG_EN_PASSANT) {
+            delta += get_piece_value(PAWN);
+        }
+
+        if (move.flags & MOVE_FLAG_PROMOTION) {
+            delta += get_piece_value(move.promotion) - get_piece_value(PAWN);
+        }
+
+        if (stand_pat + delta <= alpha) {
+            continue;
+        }
 
         struct board board_copy = *board;
         board_do_move(&board_copy, move);
+        ec_prefetch(board_copy.key);
 
-        int score = -quiescent_search(&board_copy, -beta, -alpha);
+        int score = -quiescent_search(&board_copy, -beta, -alpha, ply+1);
+
+        if (search_stopped()) {
+            return 0;
+        }
 
         if (score >= beta) {
-            return beta;
+            return score;
+        }
+
+        if (score > best_score) {
+            best_score = score;
         }
 
         if (score > alpha) {
@@ -307,7 +1276,7 @@ int quiescent_search(struct board *board, int alpha, int beta) {
         }
     }
 
-    return alpha;
+    return best_score;
 }
 
 
@@ -322,7 +1291,7 @@ static int search_negamax2(struct board *board, size_t depth, clock_t time_start
 
     struct move_list moves;
     movegen_add_moves(&moves, board);
-    init_gmove_picker(&moves, ordering_info, board);
+    init_gmove_picker(&moves, ordering_info, board, (struct move){ .flags = MOVE_FLAG_INVALID });
 
     // checkmate or stalemate
     if (moves.count == 0) {
@@ -357,13 +1326,12 @@ static int search_negamax2(struct board *board, size_t depth, clock_t time_start
 struct move search_best_move2(struct board *board) {
     clock_t time_start = clock();
     struct ordering_info ordering_info;
-    ordering_info.ply = 0;
-    memset(ordering_info.history, 0, sizeof(ordering_info.history));
+    init_ordering_info(&ordering_info);
 
     struct move_list moves;
     movegen_add_moves(&moves, board);
 
-    init_gmove_picker(&moves, &ordering_info, board);
+    init_gmove_picker(&moves, &ordering_info, board, (struct move){ .flags = MOVE_FLAG_INVALID });
 
     struct move best_move = { .flags = MOVE_FLAG_INVALID };
     int best_score = INT_MIN;
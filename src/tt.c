@@ -0,0 +1,168 @@
+#include "tt.h"
+
+#include "move.h"
+#include "zobrist.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <error.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Transposition table:
+ * https://www.chessprogramming.org/Transposition_Table
+ *
+ * Lockless hashing:
+ * https://www.chessprogramming.org/Shared_Hash_Table#Lockless
+ *
+ */
+
+/**
+ * Packed search result stored in a slot of the table.
+ */
+struct tt_data {
+    struct move move;
+
+    int32_t score;
+    int16_t depth;
+    int8_t bound;
+};
+
+/**
+ * Slot of the table. The key is stored XOR-ed with the data words so that
+ * a slot torn by concurrent writes from several threads fails the key check
+ * instead of returning a mix of two results (lockless hashing).
+ */
+struct tt_slot {
+    zb_key_t check;
+
+    union {
+        struct tt_data data;
+        uint64_t words[2];
+    };
+};
+
+_Static_assert(sizeof(struct tt_data) <= 2*sizeof(uint64_t), "tt_data must fit in two words");
+
+static struct tt_slot *tt_slots = NULL;
+
+/**
+ * Write the provided data and key into a slot.
+ */
+static void tt_slot_write(struct tt_slot *slot, zb_key_t key, struct tt_data data) {
+    union {
+        struct tt_data data;
+        uint64_t words[2];
+    } u = { .words = {0, 0} };
+
+    u.data = data;
+
+    __atomic_store_n(&slot->words[0], u.words[0], __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->words[1], u.words[1], __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->check, key ^ u.words[0] ^ u.words[1], __ATOMIC_RELAXED);
+}
+
+/**
+ * Read the data of a slot if it belongs to the provided key.
+ */
+static bool tt_slot_read(struct tt_slot *slot, zb_key_t key, struct tt_data *data) {
+    union {
+        struct tt_data data;
+        uint64_t words[2];
+    } u;
+
+    u.words[0] = __atomic_load_n(&slot->words[0], __ATOMIC_RELAXED);
+    u.words[1] = __atomic_load_n(&slot->words[1], __ATOMIC_RELAXED);
+
+    zb_key_t check = __atomic_load_n(&slot->check, __ATOMIC_RELAXED);
+
+    if ((check ^ u.words[0] ^ u.words[1]) != key || u.data.bound == TT_BOUND_NONE) {
+        return false;
+    }
+
+    *data = u.data;
+
+    return true;
+}
+
+void tt_init(void) {
+    tt_slots = malloc(TT_ENTRY_CNT*sizeof(*tt_slots));
+
+    if (tt_slots == NULL) {
+        error(EXIT_FAILURE, errno, "could not allocate space for transposition table");
+    }
+
+    tt_clear();
+}
+
+void tt_term(void) {
+    free(tt_slots);
+}
+
+void tt_clear(void) {
+    assert(tt_slots != NULL);
+
+    struct tt_data data = {
+        .move.flags = MOVE_FLAG_INVALID,
+        .bound = TT_BOUND_NONE,
+    };
+
+    for (size_t i = 0; i < TT_ENTRY_CNT; ++i) {
+        tt_slot_write(&tt_slots[i], ZB_KEY_EMPTY, data);
+    }
+}
+
+bool tt_probe(zb_key_t key, struct tt_entry *entry) {
+    assert(tt_slots != NULL);
+    assert(entry != NULL);
+
+    struct tt_data data;
+
+    if (!tt_slot_read(&tt_slots[key & (TT_ENTRY_CNT-1)], key, &data)) {
+        return false;
+    }
+
+    entry->key = key;
+    entry->move = data.move;
+    entry->score = data.score;
+    entry->depth = data.depth;
+    entry->bound = data.bound;
+
+    return true;
+}
+
+void tt_store(zb_key_t key, struct move move, int score, int depth, enum tt_bound bound) {
+    assert(tt_slots != NULL);
+    assert(bound >= 0 && bound < TT_BOUND_CNT);
+
+    struct tt_slot *slot = &tt_slots[key & (TT_ENTRY_CNT-1)];
+
+    struct tt_data old;
+
+    if (tt_slot_read(slot, key, &old)) {
+        // prefer keeping deeper results of the same position
+        if (old.depth > depth && bound != TT_BOUND_EXACT) {
+            return;
+        }
+
+        // keep the old best move if the new result did not produce one
+        if (move.flags == MOVE_FLAG_INVALID) {
+            move = old.move;
+        }
+    }
+
+    struct tt_data data = {
+        .move = move,
+        .score = score,
+        .depth = depth,
+        .bound = bound,
+    };
+
+    tt_slot_write(slot, key, data);
+}
@@ -1,16 +1,24 @@
 #include "xboard-in-cmds.h"
 
+#include "bench.h"
 #include "bitboard.h"
 #include "board.h"
 #include "engine.h"
+#include "evalcache.h"
+#include "evalparams.h"
 #include "move.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "search.h"
 #include "utils.h"
 #include "xboard.h"
 #include "xboard-out-cmds.h"
 
+#include <assert.h>
 #include <errno.h>
 #include <error.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -50,6 +58,7 @@ static const char *xb_in_cmd_strs[XB_IN_CMD_CNT] = {
     [XB_IN_CMD_POST]         = "post",
     [XB_IN_CMD_NOPOST]       = "nopost",
     [XB_IN_CMD_ANALYZE]      = "analyze",
+    [XB_IN_CMD_EXIT]         = "exit",
     [XB_IN_CMD_NAME]         = "name",
     [XB_IN_CMD_RATING]       = "rating",
     [XB_IN_CMD_ICS]          = "ics",
@@ -66,6 +75,7 @@ static const char *xb_in_cmd_strs[XB_IN_CMD_CNT] = {
     [XB_IN_CMD_LIFT]         = "lift",
     [XB_IN_CMD_PUT]          = "put",
     [XB_IN_CMD_HOVER]        = "hover",
+    [XB_IN_CMD_BENCH]        = "bench",
 };
 
 static uint32_t xb_in_cmd_hashes[XB_IN_CMD_CNT];
@@ -99,13 +109,20 @@ static void xb_in_cmd_xboard(void) {
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_SAN, false);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_USERMOVE, true);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_TIME, true);
+    xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_NPS, true);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_DRAW, true);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_SIGINT, false);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_SIGTERM, false);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_REUSE, false);
-    xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_ANALYZE, false);
+    xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_ANALYZE, true);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_MYNAME, engine.name);
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_COLORS, false);
+    xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_EXCLUDE, true);
+    xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_SMP, true);
+
+    for (enum xb_option i = 0; i < XB_OPTION_CNT; ++i) {
+        xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_OPTION, xb_option_descs[i]);
+    }
 
 #ifdef DEBUG
     xb_out_cmd(XB_OUT_CMD_FEATURE, XB_FEATURE_DEBUG, true);
@@ -199,6 +216,33 @@ static void xb_in_cmd_level(void) {
     free(base_str);
 }
 
+static void xb_in_cmd_sd(void) {
+    int depth = xb_read_int("could not read depth");
+
+    if (depth < 1) {
+        xb_err("sd", "invalid depth %d", depth);
+        return;
+    }
+
+    engine.search_options.depth = depth < SEARCH_DEPTH_MAX ? depth : SEARCH_DEPTH_MAX;
+
+    xb_commentln("searching to depth %d", engine.search_options.depth);
+}
+
+static void xb_in_cmd_nps(void) {
+    int nps = xb_read_int("could not read node rate");
+
+    if (nps < 0) {
+        xb_err("nps", "invalid node rate %d", nps);
+        return;
+    }
+
+    // a zero node rate goes back to wall clock time
+    engine.search_options.nps = nps;
+
+    xb_commentln("measuring time at %d nodes per second", nps);
+}
+
 static void xb_in_cmd_usermove(void) {
     char *move_str = xb_read_str("could not read opponent move coords");
 
@@ -207,9 +251,7 @@ static void xb_in_cmd_usermove(void) {
     enum color color = board->color;
     enum color color_other = color_flip(color);
 
-    struct move move;
-    
-    move.flags = MOVE_FLAG_NONE;
+    struct move move = { .flags = MOVE_FLAG_NONE };
 
     move.from = str_to_square(&move_str[0]);
     move.to = str_to_square(&move_str[2]);
@@ -284,7 +326,8 @@ illegal_move:
 
     engine_recv_move(move);
 
-    if (!engine.force) {
+    // in analyze mode the loop analyzes the new position instead
+    if (!engine.analyze && !engine.force) {
         engine_send_move();
     }
 }
@@ -327,6 +370,9 @@ static void xb_in_cmd_setboard(void) {
 
     board_set_fen(&engine.board, fen);
 
+    // exclusions only apply to the position they were made in
+    engine.search_options.excluded_cnt = 0;
+
     free(fen);
 }
 
@@ -339,11 +385,19 @@ static void xb_in_cmd_easy(void) {
 }
 
 static void xb_in_cmd_post(void) {
-    engine.post = true;
+    engine.search_options.post = true;
 }
 
 static void xb_in_cmd_nopost(void) {
-    engine.post = false;
+    engine.search_options.post = false;
+}
+
+static void xb_in_cmd_analyze(void) {
+    engine.analyze = true; // the loop starts the analysis
+}
+
+static void xb_in_cmd_exit(void) {
+    engine.analyze = false;
 }
 
 static void xb_in_cmd_name(void) {
@@ -360,6 +414,272 @@ static void xb_in_cmd_computer(void) {
     engine.computer = true;
 }
 
+static void xb_in_cmd_cores(void) {
+    int cores = xb_read_int("could not read number of cores");
+
+    if (cores < 1 || cores > SEARCH_THREADS_MAX) {
+        xb_err("cores", "invalid number of cores %d", cores);
+        return;
+    }
+
+    engine.search_options.threads = cores;
+
+    xb_commentln("searching with %d threads", cores);
+}
+
+/**
+ * Find the legal move of the engine board given in coordinate notation.
+ */
+static struct move xb_str_to_move(const char *move_str) {
+    assert(move_str != NULL);
+
+    struct move_list moves;
+    movegen_add_moves(&moves, &engine.board);
+
+    size_t len = strlen(move_str);
+
+    if (len < 4 || len > 5) {
+        return (struct move){ .flags = MOVE_FLAG_INVALID };
+    }
+
+    enum square from = str_to_square(&move_str[0]);
+    enum square to = str_to_square(&move_str[2]);
+
+    for (size_t i = 0; i < moves.count; ++i) {
+        struct move move = moves.list[i];
+
+        if (move.from != from || move.to != to) {
+            continue;
+        }
+
+        if (move.flags & MOVE_FLAG_PROMOTION ?
+            len == 5 && char_to_piece(move_str[4]) == move.promotion :
+            len == 4)
+        {
+            return move;
+        }
+    }
+
+    return (struct move){ .flags = MOVE_FLAG_INVALID };
+}
+
+static void xb_in_cmd_exclude(void) {
+    char *move_str = xb_read_str("could not read excluded move");
+
+    struct search_options *options = &engine.search_options;
+
+    if (strcmp(move_str, "all") == 0) {
+        struct move_list moves;
+        movegen_add_moves(&moves, &engine.board);
+
+        memcpy(options->excluded, moves.list, moves.count * sizeof *moves.list);
+        options->excluded_cnt = moves.count;
+    } else {
+        struct move move = xb_str_to_move(move_str);
+
+        if (move.flags == MOVE_FLAG_INVALID) {
+            xb_ill(move_str, "cannot exclude");
+            free(move_str);
+            return;
+        }
+
+        if (!search_is_excluded(options, move)) {
+            options->excluded[options->excluded_cnt++] = move;
+        }
+    }
+
+    xb_commentln("excluded '%s' (%zu moves excluded)", move_str, options->excluded_cnt);
+
+    free(move_str);
+}
+
+static void xb_in_cmd_include(void) {
+    char *move_str = xb_read_str("could not read included move");
+
+    struct search_options *options = &engine.search_options;
+
+    if (strcmp(move_str, "all") == 0) {
+        options->excluded_cnt = 0;
+    } else {
+        struct move move = xb_str_to_move(move_str);
+
+        if (move.flags == MOVE_FLAG_INVALID) {
+            xb_ill(move_str, "cannot include");
+            free(move_str);
+            return;
+        }
+
+        for (size_t i = 0; i < options->excluded_cnt; ++i) {
+            if (move_equal(options->excluded[i], move)) {
+                options->excluded[i] = options->excluded[--options->excluded_cnt];
+                break;
+            }
+        }
+    }
+
+    xb_commentln("included '%s' (%zu moves excluded)", move_str, options->excluded_cnt);
+
+    free(move_str);
+}
+
+#ifdef TUNE
+
+/**
+ * Drop everything computed with the previous evaluation parameters.
+ */
+static void xb_eval_params_changed(void) {
+    ec_clear();
+
+    // the pawn and material tables are allocated again (empty) by the next search
+    search_term();
+
+    board_update_pst(&engine.board);
+}
+
+#endif
+
+static void xb_in_cmd_option(void) {
+    char *option_str = xb_read_line("could not read option");
+
+    char *val_str = strchr(option_str, '=');
+
+    if (val_str != NULL) {
+        *val_str++ = '\0';
+    }
+
+    enum xb_option option = xb_str_to_option(option_str);
+
+    switch (option) {
+    case XB_OPTION_MULTI_PV: {
+        int multi_pv = val_str != NULL ? atoi(val_str) : 0;
+
+        if (multi_pv < 1 || multi_pv > SEARCH_MULTI_PV_MAX) {
+            xb_err(option_str, "invalid value");
+            break;
+        }
+
+        engine.search_options.multi_pv = multi_pv;
+
+        xb_commentln("option '%s' set to %d", option_str, multi_pv);
+
+        break;
+    }
+
+    case XB_OPTION_SEARCH: {
+        enum search_algorithm algorithm = val_str != NULL ? search_str_to_algorithm(val_str) : SEARCH_ALGORITHM_UNKNOWN;
+
+        if (algorithm == SEARCH_ALGORITHM_UNKNOWN) {
+            xb_err(option_str, "invalid value");
+            break;
+        }
+
+        engine.search_options.algorithm = algorithm;
+
+        xb_commentln("option '%s' set to '%s'", option_str, search_algorithm_strs[algorithm]);
+
+        break;
+    }
+
+    case XB_OPTION_EVAL_CACHE: {
+        int size = val_str != NULL ? atoi(val_str) : -1;
+
+        if (size < 0 || size > EC_SIZE_MAX) {
+            xb_err(option_str, "invalid value");
+            break;
+        }
+
+        ec_resize(size);
+
+        xb_commentln("option '%s' set to %d", option_str, size);
+
+        break;
+    }
+
+    case XB_OPTION_EVAL_FILE: {
+        const char *path = val_str != NULL ? val_str : "";
+
+        if (!nnue_load(path)) {
+            xb_err(option_str, "invalid network file");
+            break;
+        }
+
+        // cached evaluations come from the previous evaluation
+        ec_clear();
+
+        xb_commentln("option '%s' set to '%s' (%s)", option_str, path,
+                     nnue_is_loaded() ? nnue_get_simd() : "hand-tuned evaluation");
+
+        break;
+    }
+
+#ifdef TUNE
+    case XB_OPTION_EVAL_PARAMS: {
+        const char *path = val_str != NULL ? val_str : "";
+
+        if (!ep_load(path)) {
+            xb_err(option_str, "invalid parameter file");
+            break;
+        }
+
+        xb_eval_params_changed();
+
+        xb_commentln("option '%s' set to '%s'", option_str, path);
+
+        break;
+    }
+#endif
+
+    default:
+#ifdef TUNE
+        // single evaluation parameters are set by their names
+        if (ep_exists(option_str)) {
+            if (val_str == NULL || !ep_set(option_str, val_str)) {
+                xb_err(option_str, "invalid value");
+                break;
+            }
+
+            xb_eval_params_changed();
+
+            xb_commentln("option '%s' set to '%s'", option_str, val_str);
+
+            break;
+        }
+#endif
+
+        xb_err(option_str, "unknown option");
+    }
+
+    free(option_str);
+}
+
+static void xb_in_cmd_bench(void) {
+    int depth = BENCH_DEPTH;
+
+    // the depth is optional, so only the rest of the line is read
+    char *depth_str = xb_read_opt_line();
+
+    if (depth_str != NULL) {
+        char *end;
+        long value = strtol(depth_str, &end, 10);
+
+        // the whole argument has to be the depth (up to trailing blanks)
+        end += strspn(end, " \t\r");
+
+        if (end == depth_str || *end != '\0' || value < 1 || value > SEARCH_DEPTH_MAX) {
+            xb_err("bench", "invalid depth '%s'", depth_str);
+            free(depth_str);
+            return;
+        }
+
+        depth = value;
+
+        free(depth_str);
+    }
+
+    // the report is sent as comments, which xboard ignores
+    bench_run(depth, "# ");
+}
+
 void (*xb_in_cmds[XB_IN_CMD_CNT])(void) = {
     [XB_IN_CMD_XBOARD]       = xb_in_cmd_xboard,
     [XB_IN_CMD_PROTOVER]     = xb_in_cmd_protover,
@@ -376,8 +696,8 @@ void (*xb_in_cmds[XB_IN_CMD_CNT])(void) = {
     [XB_IN_CMD_BLACK]        = NULL,
     [XB_IN_CMD_LEVEL]        = xb_in_cmd_level,
     [XB_IN_CMD_ST]           = NULL,
-    [XB_IN_CMD_SD]           = NULL,
-    [XB_IN_CMD_NPS]          = NULL,
+    [XB_IN_CMD_SD]           = xb_in_cmd_sd,
+    [XB_IN_CMD_NPS]          = xb_in_cmd_nps,
     [XB_IN_CMD_TIME]         = xb_in_cmd_time,
     [XB_IN_CMD_OTIM]         = xb_in_cmd_otim,
     [XB_IN_CMD_USERMOVE]     = xb_in_cmd_usermove,
@@ -395,7 +715,8 @@ void (*xb_in_cmds[XB_IN_CMD_CNT])(void) = {
     [XB_IN_CMD_EASY]         = xb_in_cmd_easy,
     [XB_IN_CMD_POST]         = xb_in_cmd_post,
     [XB_IN_CMD_NOPOST]       = xb_in_cmd_nopost,
-    [XB_IN_CMD_ANALYZE]      = NULL,
+    [XB_IN_CMD_ANALYZE]      = xb_in_cmd_analyze,
+    [XB_IN_CMD_EXIT]         = xb_in_cmd_exit,
     [XB_IN_CMD_NAME]         = xb_in_cmd_name,
     [XB_IN_CMD_RATING]       = NULL,
     [XB_IN_CMD_ICS]          = NULL,
@@ -403,13 +724,14 @@ void (*xb_in_cmds[XB_IN_CMD_CNT])(void) = {
     [XB_IN_CMD_PAUSE]        = NULL,
     [XB_IN_CMD_RESUME]       = NULL,
     [XB_IN_CMD_MEMORY]       = NULL,
-    [XB_IN_CMD_CORES]        = NULL,
+    [XB_IN_CMD_CORES]        = xb_in_cmd_cores,
     [XB_IN_CMD_EGTPATH]      = NULL,
-    [XB_IN_CMD_OPTION]       = NULL,
-    [XB_IN_CMD_EXCLUDE]      = NULL,
-    [XB_IN_CMD_INCLUDE]      = NULL,
+    [XB_IN_CMD_OPTION]       = xb_in_cmd_option,
+    [XB_IN_CMD_EXCLUDE]      = xb_in_cmd_exclude,
+    [XB_IN_CMD_INCLUDE]      = xb_in_cmd_include,
     [XB_IN_CMD_SETSCORE]     = NULL,
     [XB_IN_CMD_LIFT]         = NULL,
     [XB_IN_CMD_PUT]          = NULL,
     [XB_IN_CMD_HOVER]        = NULL,
+    [XB_IN_CMD_BENCH]        = xb_in_cmd_bench,
 };
@@ -7,11 +7,13 @@
 #include <assert.h>
 #include <errno.h>
 #include <error.h>
+#include <poll.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 const char *xb_feature_strs[XB_FEATURE_CNT] = {
     [XB_FEATURE_PING]      = "ping",
@@ -130,18 +132,74 @@ enum xb_result xb_str_to_result(const char *str) {
     return XB_RESULT_UNKNOWN;
 }
 
+const char *xb_option_strs[XB_OPTION_CNT] = {
+    [XB_OPTION_MULTI_PV]   = "MultiPV",
+    [XB_OPTION_SEARCH]     = "Search",
+    [XB_OPTION_EVAL_CACHE] = "EvalCache",
+    [XB_OPTION_EVAL_FILE]  = "EvalFile",
+#ifdef TUNE
+    [XB_OPTION_EVAL_PARAMS] = "EvalParams",
+#endif
+};
+
+const char *xb_option_descs[XB_OPTION_CNT] = {
+    [XB_OPTION_MULTI_PV]   = "MultiPV -spin 1 1 64",
+    [XB_OPTION_SEARCH]     = "Search -combo *PVS /// MTD(f) /// MCTS /// df-pn",
+    [XB_OPTION_EVAL_CACHE] = "EvalCache -spin 4 0 1024", // size in MB (0 disables the cache)
+    [XB_OPTION_EVAL_FILE]  = "EvalFile -file ", // NNUE network (none uses the hand-tuned evaluation)
+#ifdef TUNE
+    [XB_OPTION_EVAL_PARAMS] = "EvalParams -file ", // parameter file of the hand-tuned evaluation
+#endif
+};
+
+static uint32_t xb_option_hashes[XB_OPTION_CNT];
+
+/**
+ * Initialize engine option hashes.
+ */
+static void xb_option_hashes_init(void) {
+    for (enum xb_option i = 0; i < XB_OPTION_CNT; ++i) {
+        xb_option_hashes[i] = hash_djb2(xb_option_strs[i]);
+    }
+}
+
+enum xb_option xb_str_to_option(const char *str) {
+    assert(str != NULL);
+
+    uint32_t hash = hash_djb2(str);
+
+    for (enum xb_option i = 0; i < XB_OPTION_CNT; ++i) {
+        if (xb_option_hashes[i] == hash) {
+            return i;
+        }
+    }
+
+    return XB_OPTION_UNKNOWN;
+}
+
 void xb_init(void) {
     xb_in_cmd_hashes_init();
     xb_feature_hashes_init();
     xb_result_hashes_init();
+    xb_option_hashes_init();
 
     // disable buffering so that xboard receives
     // the engine responses immediately
     setbuf(stdout, NULL);
+
+    // read input unbuffered so that a pending command is never
+    // held in the buffer of stdin (see `xb_input_pending`)
+    setbuf(stdin, NULL);
 }
 
 void xb_term(void) {}
 
+bool xb_input_pending(void) {
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+    return poll(&pfd, 1, 0) > 0;
+}
+
 char * xb_read_str(const char *err_str) {
     assert(err_str != NULL);
 
@@ -178,6 +236,29 @@ char * xb_read_fen(const char *err_str) {
     return fen;
 }
 
+char * xb_read_line(const char *err_str) {
+    assert(err_str != NULL);
+
+    char *line = NULL;
+
+    if (scanf(" %m[^\n]", &line) < 1) {
+        error(EXIT_FAILURE, errno, "%s", err_str);
+    }
+
+    return line;
+}
+
+char * xb_read_opt_line(void) {
+    char *line = NULL;
+
+    // only blanks are skipped, the line may end right after the command
+    if (scanf("%*[ \t]") == EOF || scanf("%m[^\n]", &line) < 1) {
+        return NULL;
+    }
+
+    return line;
+}
+
 int xb_read_int(const char *err_str) {
     assert(err_str != NULL);
 
@@ -330,6 +411,12 @@ void xb_err(const char *cmd, const char *type, ...) {
 
 void xb_loop(void) {
     while (true) {
+        // analysis runs until the next command arrives and
+        // starts over once it is handled while in analyze mode
+        if (engine.analyze) {
+            engine_analyze();
+        }
+
         char *str = xb_read_str("could not read input command");
 
         xb_commentln("input command '%s'", str);
@@ -0,0 +1,140 @@
+#include "zobrist.h"
+
+#include "bitboard.h"
+#include "board.h"
+
+#include <assert.h>
+
+/**************
+ * REFERENCES *
+ **************
+ *
+ * Zobrist hashing:
+ * https://www.chessprogramming.org/Zobrist_Hashing
+ *
+ * Xorshift pseudo-random number generators:
+ * https://www.jstatsoft.org/article/view/v008i14
+ *
+ */
+
+const zb_key_t ZB_KEY_EMPTY = (zb_key_t)0;
+
+zb_key_t zb_pieces[COLOR_CNT][PIECE_CNT][SQ_CNT];
+zb_key_t zb_castle_rights[CASTLE_RIGHT_ALL+1];
+zb_key_t zb_en_passant[FL_CNT];
+zb_key_t zb_color;
+
+/**
+ * Generate a pseudo-random key using a fixed seed
+ * so that keys are reproducible between runs.
+ */
+static zb_key_t zb_rand(void) {
+    static uint64_t state = 0x9e3779b97f4a7c15;
+
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+
+    return state*0x2545f4914f6cdd1d;
+}
+
+void zb_init(void) {
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            for (enum square s = 0; s < SQ_CNT; ++s) {
+                zb_pieces[c][p][s] = zb_rand();
+            }
+        }
+    }
+
+    // combinations of castle rights are hashed as the XOR
+    // of their individual rights so that losing a right
+    // can be done with a single XOR
+    zb_key_t zb_castle_right[4];
+
+    for (size_t i = 0; i < 4; ++i) {
+        zb_castle_right[i] = zb_rand();
+    }
+
+    for (enum castle_right cr = 0; cr <= CASTLE_RIGHT_ALL; ++cr) {
+        zb_castle_rights[cr] = ZB_KEY_EMPTY;
+
+        for (size_t i = 0; i < 4; ++i) {
+            if (cr & (1 << i)) {
+                zb_castle_rights[cr] ^= zb_castle_right[i];
+            }
+        }
+    }
+
+    for (enum file f = 0; f < FL_CNT; ++f) {
+        zb_en_passant[f] = zb_rand();
+    }
+
+    zb_color = zb_rand();
+}
+
+zb_key_t zb_get_key(struct board *board) {
+    assert(board != NULL);
+
+    zb_key_t key = ZB_KEY_EMPTY;
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            bb_t bb_pieces = board->bb_pieces[c][p];
+
+            while (bb_pieces) {
+                enum square s = bb_pop_lsb(&bb_pieces);
+
+                key ^= zb_pieces[c][p][s];
+            }
+        }
+    }
+
+    key ^= zb_castle_rights[board->castle_rights];
+
+    if (board->en_passant != SQ_NONE) {
+        key ^= zb_en_passant[square_to_file(board->en_passant)];
+    }
+
+    if (board->color == BLACK) {
+        key ^= zb_color;
+    }
+
+    return key;
+}
+
+zb_key_t zb_get_pawn_key(struct board *board) {
+    assert(board != NULL);
+
+    zb_key_t key = ZB_KEY_EMPTY;
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        bb_t bb_pawns = board->bb_pieces[c][BB_PAWNS];
+
+        while (bb_pawns) {
+            enum square s = bb_pop_lsb(&bb_pawns);
+
+            key ^= zb_pieces[c][PAWN][s];
+        }
+    }
+
+    return key;
+}
+
+zb_key_t zb_get_material_key(struct board *board) {
+    assert(board != NULL);
+
+    zb_key_t key = ZB_KEY_EMPTY;
+
+    for (enum color c = 0; c < COLOR_CNT; ++c) {
+        for (enum piece p = 0; p < PIECE_CNT; ++p) {
+            int cnt = bb_bit_cnt(board->bb_pieces[c][p]);
+
+            for (int i = 0; i < cnt; ++i) {
+                key ^= zb_pieces[c][p][i];
+            }
+        }
+    }
+
+    return key;
+}